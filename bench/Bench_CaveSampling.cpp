@@ -0,0 +1,115 @@
+// Cave sampling benchmark.
+// Generates the same chunks with full resolution cave noise and with several lattice strides, and compares generation
+// throughput and the resulting blocks: blocks differing from the full resolution chunks, and how well the underground
+// air (caves) overlaps.
+
+#include <cstdint>
+#include <print>
+#include <vector>
+#include "Bench_Common.hpp"
+#include "World_Generation.hpp"
+#include "Utility_Timer.hpp"
+
+namespace
+{
+    constexpr int            GRID_SIZE = 12;
+    constexpr World_Chunk_ID ORIGIN{ -40, 0, 25 };
+
+    struct GeneratedGrid
+    {
+        Bench_ChunkGrid Grid;
+        double          Seconds = 0.0;
+    };
+
+    GeneratedGrid Generate(const World_Generation_Settings& settings)
+    {
+        World_Generation_SetSettings(settings);
+
+        GeneratedGrid generated{ Bench_AllocateChunkGrid(GRID_SIZE, ORIGIN) };
+
+        Timer timer;
+        for (auto& chunk : generated.Grid.Chunks) World_Generation_GenerateChunk(chunk.get());
+        generated.Seconds = timer.Elapsed();
+
+        return generated;
+    }
+
+    struct Comparison
+    {
+        double MismatchRatio = 0.0; // Blocks differing from the reference
+        double CaveOverlap   = 0.0; // Intersection over union of the air below the reference terrain surface
+        double CaveRatio     = 0.0; // Air below the reference terrain surface, relative to the reference
+    };
+
+    Comparison Compare(const Bench_ChunkGrid& reference, const Bench_ChunkGrid& grid)
+    {
+        std::uint64_t mismatches = 0, both = 0, either = 0, reference_caves = 0, caves = 0;
+
+        for (std::size_t i = 0; i < reference.Chunks.size(); i++)
+        {
+            const World_Chunk& a = *reference.Chunks[i];
+            const World_Chunk& b = *grid.Chunks[i];
+
+            for (int z = 0; z < World_CHUNK_Z_SIZE; z++)
+            for (int x = 0; x < World_CHUNK_X_SIZE; x++)
+            {
+                const int surface = a.Storage->Heights.At(x, z);
+
+                for (int y = 0; y < World_CHUNK_Y_SIZE; y++)
+                {
+                    const World_Block block_a = a.GetBlockAt(World_LocalXYZ{ x, y, z });
+                    const World_Block block_b = b.GetBlockAt(World_LocalXYZ{ x, y, z });
+
+                    mismatches += block_a != block_b;
+
+                    if (y >= surface) continue;
+
+                    const bool cave_a = block_a.ID == World_Block_ID::AIR;
+                    const bool cave_b = block_b.ID == World_Block_ID::AIR;
+
+                    both            += cave_a && cave_b;
+                    either          += cave_a || cave_b;
+                    reference_caves += cave_a;
+                    caves           += cave_b;
+                }
+            }
+        }
+
+        const double volume = static_cast<double>(reference.Chunks.size()) * World_CHUNK_VOLUME;
+
+        return Comparison{
+            static_cast<double>(mismatches) / volume,
+            either          != 0 ? static_cast<double>(both) / static_cast<double>(either) : 1.0,
+            reference_caves != 0 ? static_cast<double>(caves) / static_cast<double>(reference_caves) : 1.0 };
+    }
+}
+
+int main()
+{
+    World_Generation_Initialize(1337);
+
+    const std::size_t chunk_count = GRID_SIZE * GRID_SIZE;
+
+    // Warm up the thread local sample storage and the caches.
+    Generate(World_Generation_Settings{});
+
+    const GeneratedGrid reference = Generate(World_Generation_Settings{});
+
+    std::println("Cave sampling, {} chunks", chunk_count);
+    std::println("  full resolution  : {:6.2f} ms/chunk, {:6.0f} chunks/s", 1e3 * reference.Seconds / static_cast<double>(chunk_count), static_cast<double>(chunk_count) / reference.Seconds);
+
+    for (glm::ivec3 stride : { glm::ivec3{ 2, 2, 2 }, glm::ivec3{ 2, 4, 2 }, glm::ivec3{ 4, 4, 4 }, glm::ivec3{ 4, 8, 4 }, glm::ivec3{ 8, 16, 8 } })
+    {
+        const GeneratedGrid generated = Generate(World_Generation_Settings{ World_Generation_CaveSampling::Lattice, stride });
+
+        const Comparison comparison = Compare(reference.Grid, generated.Grid);
+
+        std::println("  lattice {:2}x{:2}x{:<2} : {:6.2f} ms/chunk, {:6.0f} chunks/s ({:4.1f}x), blocks differing {:5.2f}%, cave overlap {:5.1f}%, cave volume {:5.1f}%",
+            stride.x, stride.y, stride.z, 1e3 * generated.Seconds / static_cast<double>(chunk_count), static_cast<double>(chunk_count) / generated.Seconds, reference.Seconds / generated.Seconds,
+            100.0 * comparison.MismatchRatio, 100.0 * comparison.CaveOverlap, 100.0 * comparison.CaveRatio);
+    }
+
+    World_Generation_SetSettings(World_Generation_Settings{});
+
+    return 0;
+}
@@ -0,0 +1,262 @@
+// Chunk lookup benchmark.
+// Compares world block reads through the former locked hash map lookup, the lock-free grid lookup, and the grid lookup
+// behind the per-thread snapshot cache (World_ChunkManager::GetChunkSnapshotAt), with random and coherent positions,
+// from one thread and from several threads at once.
+
+#include <cstdint>
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <print>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Bench_Common.hpp"
+#include "World_Generation.hpp"
+#include "World_ChunkManager.hpp"
+#include "Utility_Timer.hpp"
+
+namespace
+{
+    constexpr std::size_t RENDER_DISTANCE = 4;
+    constexpr std::size_t LOOKUPS         = 1 << 20;
+    constexpr int         COHERENT_RUN    = 64; // Steps of a coherent walk before it restarts elsewhere.
+
+    using Positions = std::vector<World_GlobalXYZ>;
+
+    struct XorShift
+    {
+        std::uint32_t State;
+
+        std::uint32_t Next() { State ^= State << 13; State ^= State >> 17; State ^= State << 5; return State; }
+        int           Range(int n) { return static_cast<int>(Next() % static_cast<std::uint32_t>(n)); }
+    };
+
+    // Positions within the render area, which is fully loaded.
+    World_GlobalXYZ RandomPosition(XorShift& random)
+    {
+        constexpr int extent = static_cast<int>(2 * RENDER_DISTANCE + 1);
+
+        return World_GlobalXYZ{
+            (random.Range(extent) - static_cast<int>(RENDER_DISTANCE)) * World_CHUNK_X_SIZE + random.Range(World_CHUNK_X_SIZE),
+            random.Range(World_CHUNK_Y_SIZE),
+            (random.Range(extent) - static_cast<int>(RENDER_DISTANCE)) * World_CHUNK_Z_SIZE + random.Range(World_CHUNK_Z_SIZE) };
+    }
+
+    Positions MakeRandomPositions(std::uint32_t seed)
+    {
+        XorShift  random{ seed };
+        Positions positions(LOOKUPS);
+
+        for (auto& p : positions) p = RandomPosition(random);
+
+        return positions;
+    }
+
+    // Unit steps along a random axis direction, as a raycast or a physics query walks the world.
+    Positions MakeCoherentPositions(std::uint32_t seed)
+    {
+        constexpr int limit = static_cast<int>(RENDER_DISTANCE) * World_CHUNK_X_SIZE;
+
+        XorShift  random{ seed };
+        Positions positions(LOOKUPS);
+
+        World_GlobalXYZ p{};
+        World_GlobalXYZ step{};
+
+        for (std::size_t i = 0; i < LOOKUPS; i++)
+        {
+            if (i % COHERENT_RUN == 0)
+            {
+                p    = RandomPosition(random);
+                step = World_GlobalXYZ{ random.Range(3) - 1, random.Range(3) - 1, random.Range(3) - 1 };
+            }
+
+            p.x = std::clamp(p.x + step.x, -limit, limit + World_CHUNK_X_SIZE - 1);
+            p.y = std::clamp(p.y + step.y, 0,      World_CHUNK_Y_SIZE - 1);
+            p.z = std::clamp(p.z + step.z, -limit, limit + World_CHUNK_Z_SIZE - 1);
+
+            positions[i] = p;
+        }
+
+        return positions;
+    }
+
+    // Lookup through a hash map under a mutex, as every world query did before the chunk grid.
+    struct LockedChunkMap
+    {
+        std::unordered_map<World_Chunk_ID, const World_Chunk*> Chunks;
+        mutable std::mutex                                     Mutex;
+
+        World_Block GetBlockAt(World_GlobalXYZ global) const
+        {
+            const World_Chunk* chunk = nullptr;
+
+            {
+                std::lock_guard<std::mutex> lock{ Mutex };
+
+                if (auto iter = Chunks.find(World_FromGlobalToChunkID(global)); iter != Chunks.end()) chunk = iter->second;
+            }
+
+            return chunk ? chunk->GetBlockAt(World_FromGlobalToLocal(global)) : World_Block{ World_Block_ID::AIR };
+        }
+    };
+
+    // Lookup threads shared by every run, the reader threads the chunk reclamation registers stay the same.
+    class LookupThreads
+    {
+    public:
+        explicit LookupThreads(std::size_t count) :
+            m_Start(static_cast<std::ptrdiff_t>(count + 1)),
+            m_Done(static_cast<std::ptrdiff_t>(count + 1))
+        {
+            for (std::size_t t = 0; t < count; t++)
+            {
+                m_Threads.emplace_back([this, t]
+                {
+                    while (true)
+                    {
+                        m_Start.arrive_and_wait();
+
+                        if (m_Stop) return;
+
+                        if (t < m_ActiveCount) (*m_Work)(t);
+
+                        m_Done.arrive_and_wait();
+                    }
+                });
+            }
+        }
+
+        ~LookupThreads()
+        {
+            m_Stop = true;
+            m_Start.arrive_and_wait();
+        }
+
+        // Runs work(t) on the first active_count threads, returns the wall time.
+        double Run(std::size_t active_count, const std::function<void(std::size_t)>& work)
+        {
+            m_Work        = &work;
+            m_ActiveCount = active_count;
+
+            Timer timer;
+            m_Start.arrive_and_wait();
+            m_Done.arrive_and_wait();
+
+            return timer.Elapsed();
+        }
+
+    private:
+        std::barrier<>                          m_Start;
+        std::barrier<>                          m_Done;
+        const std::function<void(std::size_t)>* m_Work = nullptr;
+        std::size_t                             m_ActiveCount = 0;
+        bool                                    m_Stop = false;
+        std::vector<std::jthread>               m_Threads; // Last, joined before the barriers are destroyed
+    };
+
+    template<typename F>
+    double RunLookups(LookupThreads& threads, const std::vector<Positions>& positions, std::size_t thread_count, F&& lookup)
+    {
+        std::vector<std::uint32_t> sums(thread_count);
+
+        const double seconds = threads.Run(thread_count, [&](std::size_t t)
+        {
+            std::uint32_t sum = 0;
+
+            for (const auto& p : positions[t]) sum += static_cast<std::uint32_t>(lookup(p).ID);
+
+            sums[t] = sum;
+        });
+
+        Bench_DoNotOptimize(sums);
+
+        return seconds;
+    }
+
+    void Report(const char* name, LookupThreads& threads, const World_ChunkManager& manager, const LockedChunkMap& locked, const std::vector<Positions>& positions, std::size_t thread_count)
+    {
+        const std::vector<Positions> used(positions.begin(), positions.begin() + static_cast<std::ptrdiff_t>(thread_count));
+
+        const double locked_seconds = RunLookups(threads, used, thread_count, [&](World_GlobalXYZ p) { return locked.GetBlockAt(p); });
+
+        const double grid_seconds = RunLookups(threads, used, thread_count, [&](World_GlobalXYZ p)
+        {
+            World_ChunkReadGuard guard;
+
+            auto chunk = manager.GetChunkAt(p);
+
+            if (!chunk) return World_Block{ World_Block_ID::AIR };
+
+            const World_ChunkSnapshotPtr snapshot = chunk.value()->Snapshot.load(std::memory_order_acquire);
+
+            return snapshot ? snapshot->Storage->GetBlockAt(World_FromGlobalToLocal(p)) : World_Block{ World_Block_ID::AIR };
+        });
+
+        const double cached_seconds = RunLookups(threads, used, thread_count, [&](World_GlobalXYZ p)
+        {
+            const World_ChunkSnapshot* snapshot = manager.GetChunkSnapshotAt(p);
+
+            return snapshot ? snapshot->Storage->GetBlockAt(World_FromGlobalToLocal(p)) : World_Block{ World_Block_ID::AIR };
+        });
+
+        const double lookups = static_cast<double>(LOOKUPS * thread_count);
+
+        std::println("  {} positions, {} thread(s): locked map {:.1f} ns, grid {:.1f} ns, grid + cache {:.1f} ns per lookup (wall / total lookups)",
+            name, thread_count, 1e9 * locked_seconds / lookups, 1e9 * grid_seconds / lookups, 1e9 * cached_seconds / lookups);
+    }
+}
+
+int main()
+{
+    World_Generation_Initialize(1337);
+
+    TaskScheduler      scheduler;
+    World_ChunkManager manager{ scheduler };
+    manager.SetRenderDistance(RENDER_DISTANCE);
+
+    // Load and light the render area around the origin.
+    Timer timer;
+    while (true)
+    {
+        manager.SetCenterChunk_MainThread(World_Chunk_ID{ 0, 0, 0 }, glm::vec3(0.0f, 0.0f, -1.0f), 0.8f);
+
+        const auto chunks = manager.GetChunksInRenderArea_MainThread();
+
+        const bool ready = std::all_of(chunks.begin(), chunks.end(), [](const World_Chunk* c) { return c->Stage().load(std::memory_order_acquire) == World_Chunk_Stage::NeighbourLightingComplete; });
+
+        if (ready) break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::println("Loaded {} chunks in {:.2f}s", manager.GetLoadedChunkCount(), timer.Elapsed());
+
+    LockedChunkMap locked;
+    for (const World_Chunk* chunk : manager.GetChunksInRenderArea_MainThread()) locked.Chunks.emplace(chunk->ID, chunk);
+
+    const std::size_t max_threads = std::max<std::size_t>(4, std::thread::hardware_concurrency());
+
+    std::vector<Positions> random;
+    std::vector<Positions> coherent;
+
+    for (std::size_t t = 0; t < max_threads; t++)
+    {
+        random.push_back(MakeRandomPositions(0x9E3779B9u + static_cast<std::uint32_t>(t)));
+        coherent.push_back(MakeCoherentPositions(0x85EBCA6Bu + static_cast<std::uint32_t>(t)));
+    }
+
+    std::println("Block lookups, {} per thread", LOOKUPS);
+
+    LookupThreads lookup_threads{ max_threads };
+
+    for (std::size_t threads : { std::size_t{ 1 }, max_threads })
+    {
+        Report("random  ", lookup_threads, manager, locked, random, threads);
+        Report("coherent", lookup_threads, manager, locked, coherent, threads);
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Chunk scheduling benchmark.
+// Streams chunks in with the full worker pool while the center moves at a steady pace, and measures the main thread's
+// per-frame scheduling work (center update and the renderer's stage poll) alongside the workers' throughput.
+// Runs once with the former polling dispatch and once with dependency counting, to compare the jobs they waste.
+
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <thread>
+#include <vector>
+#include "World_Generation.hpp"
+#include "World_ChunkManager.hpp"
+#include "Utility_Timer.hpp"
+
+namespace
+{
+    constexpr std::size_t RENDER_DISTANCE  = 12;
+    constexpr int         FRAMES           = 2000;
+    constexpr int         FRAMES_PER_CHUNK = 24;   // Center moves one chunk every FRAMES_PER_CHUNK frames.
+    constexpr double      FRAME_SECONDS    = 0.004;
+
+    double Percentile(std::vector<double> samples, double p)
+    {
+        auto nth = samples.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), nth, samples.end());
+
+        return *nth;
+    }
+
+    struct StreamingResult
+    {
+        double              Seconds = 0.0;
+        std::vector<double> CenterSeconds;
+        std::vector<double> PollSeconds;
+        std::uint64_t       ExecutedJobs = 0;
+        std::uint64_t       WastedJobs   = 0;
+        std::size_t         Renderable   = 0;
+        std::size_t         Loaded       = 0;
+
+        World_ChunkManager::LatencyPercentiles Latency;
+    };
+
+    StreamingResult Stream(TaskScheduler& scheduler, bool polling_dispatch)
+    {
+        World_ChunkManager manager{ scheduler };
+        manager.SetRenderDistance(RENDER_DISTANCE);
+        manager.SetPollingDispatch(polling_dispatch);
+
+        StreamingResult result;
+
+        Timer total;
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            Timer frame_timer;
+
+            const World_Chunk_ID center{ frame / FRAMES_PER_CHUNK, 0, 0 };
+
+            Timer timer;
+            manager.SetCenterChunk_MainThread(center, glm::vec3(1.0f, 0.0f, 0.0f), 0.8f);
+            result.CenterSeconds.push_back(timer.Elapsed());
+
+            // Same poll as Graphics_WorldRenderer::PrepareChunksToRender.
+            timer.Reset();
+            result.Renderable = 0;
+            for (const World_Chunk* chunk : manager.GetChunksInRenderArea_MainThread())
+            {
+                if (chunk->IsNeighbourhoodLit()) result.Renderable++;
+            }
+            result.PollSeconds.push_back(timer.Elapsed());
+
+            const double remaining = FRAME_SECONDS - frame_timer.Elapsed();
+            if (remaining > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+        }
+        result.Seconds = total.Elapsed();
+
+        result.ExecutedJobs = manager.GetExecutedJobCount();
+        result.WastedJobs   = manager.GetWastedJobCount();
+        result.Latency      = manager.GetInnerRingTimeToRenderable();
+        result.Loaded       = manager.GetLoadedChunkCount();
+
+        return result;
+    }
+
+    void Report(const char* name, const StreamingResult& result)
+    {
+        std::println("  {}:", name);
+        std::println("    center update : median {:.1f} us, p99 {:.1f} us", 1e6 * Percentile(result.CenterSeconds, 0.5), 1e6 * Percentile(result.CenterSeconds, 0.99));
+        std::println("    stage poll    : median {:.1f} us, p99 {:.1f} us", 1e6 * Percentile(result.PollSeconds, 0.5), 1e6 * Percentile(result.PollSeconds, 0.99));
+        std::println("    jobs          : {:.0f} executed/s, {} wasted ({:.1f}%)", static_cast<double>(result.ExecutedJobs) / result.Seconds, result.WastedJobs,
+            result.ExecutedJobs == 0 ? 0.0 : 100.0 * static_cast<double>(result.WastedJobs) / static_cast<double>(result.ExecutedJobs));
+        std::println("    inner ring time to renderable : median {:.1f} ms, p99 {:.1f} ms ({} samples)", 1000.0 * result.Latency.Median, 1000.0 * result.Latency.P99, result.Latency.SampleCount);
+        std::println("    renderable at the end : {}, loaded {}", result.Renderable, result.Loaded);
+    }
+}
+
+int main()
+{
+    World_Generation_Initialize(1337);
+
+    TaskScheduler scheduler;
+
+    std::println("Streaming {} frames, render distance {}, {} workers", FRAMES, RENDER_DISTANCE, scheduler.GetWorkerCount());
+
+    // Same run with the former polling dispatch, then with dependency counting.
+    Report("polling dispatch", Stream(scheduler, true));
+    Report("dependency counting", Stream(scheduler, false));
+
+    return 0;
+}
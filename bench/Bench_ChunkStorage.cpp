@@ -0,0 +1,231 @@
+// Chunk block storage benchmark.
+// Compares resident memory and meshing throughput of the sectioned, palette compressed storage
+// against flat one-byte-per-block arrays.
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <print>
+#include <vector>
+#include "Bench_Common.hpp"
+#include "Graphics_Mesh.hpp"
+#include "Utility_Timer.hpp"
+
+namespace
+{
+    constexpr int GRID_SIZE   = 10;
+    constexpr int MESH_ROUNDS = 3;
+    constexpr int READ_ROUNDS = 4;
+
+    void ReportMemory(const Bench_ChunkGrid& grid)
+    {
+        std::size_t total = 0;
+        std::size_t min   = SIZE_MAX;
+        std::size_t max   = 0;
+
+        std::size_t uniform_block_sections = 0;
+        std::size_t uniform_light_sections = 0;
+        std::array<std::size_t, 9> bits_histogram{};
+
+        for (const auto& chunk : grid.Chunks)
+        {
+            const std::size_t bytes = chunk->GetMemoryUsage() - sizeof(World_Chunk);
+
+            total += bytes;
+            min = std::min(min, bytes);
+            max = std::max(max, bytes);
+
+            for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+            {
+                const World_Chunk_SectionBlockData* blocks = chunk->Storage->SectionBlocks[s].load(std::memory_order_relaxed);
+
+                if (blocks == nullptr) uniform_block_sections++;
+                else                   bits_histogram[blocks->GetBitsPerElement()]++;
+
+                if (chunk->GetSectionUniformLight(s)) uniform_light_sections++;
+            }
+        }
+
+        // One byte per block and per light, as stored before palette compression and sections.
+        const std::size_t flat = 2 * World_CHUNK_VOLUME + sizeof(World_Chunk_HeightData);
+        const double      avg  = static_cast<double>(total) / static_cast<double>(grid.Chunks.size());
+
+        std::println("Block and light memory per chunk (bytes), {} chunks", grid.Chunks.size());
+        std::println("  flat     : {}", flat);
+        std::println("  sections : avg {:.0f}, min {}, max {} ({:.1f}% of flat)", avg, min, max, 100.0 * avg / static_cast<double>(flat));
+        std::println("  unallocated uniform sections : blocks {}, lights {} of {}",
+            uniform_block_sections, uniform_light_sections, grid.Chunks.size() * World_CHUNK_SECTION_COUNT);
+        std::println("  bits per block of allocated sections : 0={} 1={} 2={} 4={} 8={}",
+            bits_histogram[0], bits_histogram[1], bits_histogram[2], bits_histogram[4], bits_histogram[8]);
+
+        auto print_pool = [](const char* name, World_Chunk_PoolOccupancy occupancy)
+        {
+            std::println("  {} pool : {} / {} used, {} from heap, {} KB touched", name, occupancy.Used, occupancy.Capacity, occupancy.Overflow, occupancy.Bytes / 1024);
+        };
+
+        print_pool("storage      ", World_Chunk_GetStoragePoolOccupancy());
+        print_pool("section block", World_Chunk_GetSectionBlockPoolOccupancy());
+        print_pool("section light", World_Chunk_GetSectionLightPoolOccupancy());
+    }
+
+    void ReportMeshing(const Bench_ChunkGrid& grid)
+    {
+        std::vector<World_Chunk*> inner;
+        grid.ForEachInner([&](World_Chunk* c) { inner.push_back(c); });
+
+        // Flat path: blocks readily available uncompressed, as with the former one-byte-per-block storage.
+        std::vector<std::unique_ptr<World_Chunk_PaddedBlockData>> flat_blocks;
+
+        for (World_Chunk* c : inner)
+        {
+            flat_blocks.push_back(std::make_unique<World_Chunk_PaddedBlockData>());
+            c->DecodePaddedBlocks(*flat_blocks.back());
+        }
+
+        std::size_t vertices = 0;
+
+        Timer timer;
+        for (int r = 0; r < MESH_ROUNDS; r++)
+        {
+            for (std::size_t i = 0; i < inner.size(); i++)
+            {
+                auto mesh = Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(inner[i], *flat_blocks[i]);
+                vertices += mesh.Vertices.size();
+            }
+        }
+        const double flat_seconds = timer.Elapsed();
+
+        timer.Reset();
+        for (int r = 0; r < MESH_ROUNDS; r++)
+        {
+            for (World_Chunk* c : inner)
+            {
+                auto mesh = Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(c);
+                vertices += mesh.Vertices.size();
+            }
+        }
+        const double sections_seconds = timer.Elapsed();
+
+        auto padded = std::make_unique<World_Chunk_PaddedBlockData>();
+
+        timer.Reset();
+        for (int r = 0; r < MESH_ROUNDS; r++)
+        {
+            for (World_Chunk* c : inner)
+            {
+                c->DecodePaddedBlocks(*padded);
+                Bench_DoNotOptimize(*padded);
+            }
+        }
+        const double decode_seconds = timer.Elapsed();
+
+        const double meshed = static_cast<double>(inner.size() * MESH_ROUNDS);
+
+        std::println("Meshing with ambient occlusion, {} chunks x {} rounds ({} vertices)", inner.size(), MESH_ROUNDS, vertices);
+        std::println("  flat    : {:8.1f} chunks/s", meshed / flat_seconds);
+        std::println("  sections: {:8.1f} chunks/s (padded decode alone {:.3f} ms/chunk)", meshed / sections_seconds, 1000.0 * decode_seconds / meshed);
+    }
+
+    void ReportAllocationChurn()
+    {
+        // Unloading and loading a ring of chunks: storages come and go in batches, each with a few lit sections.
+        constexpr int BATCH  = 256;
+        constexpr int ROUNDS = 64;
+
+        std::vector<World_Chunk_StoragePtr> pooled(BATCH);
+        std::vector<std::unique_ptr<std::array<World_Light, 2 * World_CHUNK_VOLUME>>> heap(BATCH);
+
+        World_Chunk chunk{ World_Chunk_ID{ 0, 0, 0 } };
+
+        Timer timer;
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            for (auto& storage : pooled)
+            {
+                storage = World_Chunk_AllocateStorage();
+
+                // Writes into a few sections allocate their light data.
+                chunk.Storage = std::move(storage);
+                for (int s = 4; s < 8; s++) chunk.SetSunlightAt(World_LocalXYZ(0, s * World_CHUNK_SECTION_Y_SIZE, 0), World_LIGHT_LEVEL_SUN);
+                storage = std::move(chunk.Storage);
+            }
+
+            for (auto& storage : pooled) storage.reset();
+        }
+        const double pooled_seconds = timer.Elapsed();
+
+        timer.Reset();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            for (auto& storage : heap)
+            {
+                storage = std::make_unique<std::array<World_Light, 2 * World_CHUNK_VOLUME>>();
+                Bench_DoNotOptimize(*storage);
+            }
+
+            for (auto& storage : heap) storage.reset();
+        }
+        const double heap_seconds = timer.Elapsed();
+
+        const double allocations = static_cast<double>(BATCH * ROUNDS);
+
+        std::println("Storage allocation churn, {} x {} storages", ROUNDS, BATCH);
+        std::println("  flat 128 KB storage, heap : {:.2f} us/storage", 1e6 * heap_seconds / allocations);
+        std::println("  pooled storage + 4 lit sections : {:.2f} us/storage", 1e6 * pooled_seconds / allocations);
+    }
+
+    void ReportRandomReads(const Bench_ChunkGrid& grid)
+    {
+        const World_Chunk* chunk = grid.At(grid.Size / 2, grid.Size / 2);
+
+        auto flat = std::make_unique<World_Chunk_FlatBlockData>();
+        chunk->DecodeBlocks(*flat);
+
+        // Same pseudo random positions for both layouts.
+        std::vector<World_LocalXYZ> positions(1 << 16);
+        std::uint32_t state = 0x9E3779B9u;
+
+        for (auto& p : positions)
+        {
+            state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+            p = World_LocalXYZ{ static_cast<int>(state & 15), static_cast<int>((state >> 4) & 255), static_cast<int>((state >> 12) & 15) };
+        }
+
+        std::uint32_t sum = 0;
+
+        Timer timer;
+        for (int r = 0; r < READ_ROUNDS; r++)
+            for (const auto& p : positions) sum += static_cast<std::uint32_t>(flat->At(p.x, p.y, p.z).ID);
+        const double flat_seconds = timer.Elapsed();
+
+        timer.Reset();
+        for (int r = 0; r < READ_ROUNDS; r++)
+            for (const auto& p : positions) sum += static_cast<std::uint32_t>(chunk->GetBlockAt(p).ID);
+        const double sections_seconds = timer.Elapsed();
+
+        Bench_DoNotOptimize(sum);
+
+        const double reads = static_cast<double>(positions.size() * READ_ROUNDS);
+
+        std::println("Random block reads");
+        std::println("  flat    : {:.2f} ns/read", 1e9 * flat_seconds / reads);
+        std::println("  sections: {:.2f} ns/read", 1e9 * sections_seconds / reads);
+    }
+}
+
+int main()
+{
+    World_Generation_Initialize(1337);
+
+    Timer timer;
+    const Bench_ChunkGrid grid = Bench_CreateChunkGrid(GRID_SIZE);
+    std::println("Generated and lit {} chunks in {:.2f}s", grid.Chunks.size(), timer.Elapsed());
+
+    ReportMemory(grid);
+    ReportMeshing(grid);
+    ReportRandomReads(grid);
+    ReportAllocationChurn();
+
+    return 0;
+}
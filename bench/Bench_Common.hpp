@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+#include "World_Chunk.hpp"
+#include "World_Generation.hpp"
+#include "World_Light.hpp"
+
+// Square grid of generated chunks, associated with their neighbours.
+// Only the inner chunks (excluding the outermost ring) are neighbour set and locally lit.
+struct Bench_ChunkGrid
+{
+    int Size = 0;
+    std::vector<std::unique_ptr<World_Chunk>> Chunks;
+
+    World_Chunk* At(int x, int z) const { return Chunks[x * Size + z].get(); }
+
+    template<typename F>
+    void ForEachInner(F&& f) const
+    {
+        for (int x = 1; x < Size - 1; x++)
+        for (int z = 1; z < Size - 1; z++)
+        {
+            f(At(x, z));
+        }
+    }
+};
+
+// Allocated and neighbour linked, not yet generated.
+inline Bench_ChunkGrid Bench_AllocateChunkGrid(int size, World_Chunk_ID origin = { 0, 0, 0 })
+{
+    Bench_ChunkGrid grid;
+    grid.Size = size;
+
+    for (int x = 0; x < size; x++)
+    for (int z = 0; z < size; z++)
+    {
+        auto chunk = std::make_unique<World_Chunk>(World_Chunk_ID{ origin.x + x, 0, origin.z + z });
+        chunk->Storage = World_Chunk_AllocateStorage();
+        grid.Chunks.push_back(std::move(chunk));
+    }
+
+    for (int x = 0; x < size; x++)
+    for (int z = 0; z < size; z++)
+    {
+        World_Chunk* c = grid.At(x, z);
+        bool all_set = true;
+
+        for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
+        {
+            const int nx = x + World_Chunk_NEIGHBOUR_OFFSETS[n].x;
+            const int nz = z + World_Chunk_NEIGHBOUR_OFFSETS[n].z;
+
+            if (nx < 0 || nx >= size || nz < 0 || nz >= size) { all_set = false; continue; }
+
+            c->Neighbours[n].store(grid.At(nx, nz), std::memory_order_relaxed);
+        }
+
+        c->NeighboursSet().store(all_set, std::memory_order_relaxed);
+    }
+
+    return grid;
+}
+
+inline Bench_ChunkGrid Bench_CreateChunkGrid(int size, World_Chunk_ID origin = { 0, 0, 0 })
+{
+    Bench_ChunkGrid grid = Bench_AllocateChunkGrid(size, origin);
+
+    for (auto& chunk : grid.Chunks) World_Generation_GenerateChunk(chunk.get());
+
+    grid.ForEachInner([](World_Chunk* c) { World_Light_PropagateInitialSunlight(c); });
+
+    return grid;
+}
+
+// Keeps the optimizer from discarding benchmarked results.
+// MSVC has no inline assembly on x64: the address escapes through a volatile store instead.
+template<typename T>
+inline void Bench_DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    static const void* volatile sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
@@ -0,0 +1,138 @@
+// Generation kernel benchmark.
+// Classifies the sections of a set of chunk columns with the block classification kernel and with its scalar reference,
+// checks that both agree and compares their throughput. Inputs are smooth synthetic fields shaped like the generator's:
+// rolling terrain heights and cave noise forming caves of a few blocks across, so branches behave as on real terrain.
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <print>
+#include <vector>
+#include "World_GenerationKernel.hpp"
+#include "Utility_Timer.hpp"
+
+namespace
+{
+    constexpr int COLUMN_COUNT = 64; // Chunk columns, all sections up to the terrain
+    constexpr int REPETITIONS  = 20;
+
+    constexpr int SECTION_VOLUME = World_CHUNK_X_SIZE * World_CHUNK_SECTION_Y_SIZE * World_CHUNK_Z_SIZE;
+
+    struct Section
+    {
+        std::vector<float> Cheese;
+        std::vector<float> Spaghetti1;
+        std::vector<float> Spaghetti2;
+        const int*         Heights = nullptr;
+        int                YBase = 0;
+
+        World_GenerationKernel_SectionSamples Samples() const
+        {
+            return World_GenerationKernel_SectionSamples{ Cheese.data(), Spaghetti1.data(), Spaghetti2.data(),
+                                                          World_CHUNK_X_SIZE, World_CHUNK_X_SIZE * World_CHUNK_SECTION_Y_SIZE };
+        }
+    };
+
+    using ClassifyFunction = void (*)(const World_GenerationKernel_SectionSamples&, const int*, int, int, World_Block_ID*, int*);
+
+    double Run(const std::vector<Section>& sections, ClassifyFunction classify, std::vector<World_Block_ID>& ids, std::vector<int>& tops)
+    {
+        ids.resize(sections.size() * SECTION_VOLUME);
+        tops.resize(sections.size() * World_CHUNK_X_SIZE * World_CHUNK_Z_SIZE);
+
+        Timer timer;
+
+        for (int r = 0; r < REPETITIONS; r++)
+        {
+            for (std::size_t i = 0; i < sections.size(); i++)
+            {
+                const Section& section = sections[i];
+
+                classify(section.Samples(), section.Heights, World_CHUNK_X_SIZE, section.YBase,
+                         &ids[i * SECTION_VOLUME], &tops[i * World_CHUNK_X_SIZE * World_CHUNK_Z_SIZE]);
+            }
+        }
+
+        return timer.Elapsed() / REPETITIONS;
+    }
+}
+
+int main()
+{
+    // Inputs
+    std::vector<std::vector<int>> column_heights(COLUMN_COUNT);
+    std::vector<Section>          sections;
+
+    for (int c = 0; c < COLUMN_COUNT; c++)
+    {
+        const int cx = (c % 8) * World_CHUNK_X_SIZE;
+        const int cz = (c / 8) * World_CHUNK_Z_SIZE;
+
+        std::vector<int>& heights = column_heights[c];
+        heights.resize(World_CHUNK_X_SIZE * World_CHUNK_Z_SIZE);
+
+        int max_height = 0;
+
+        for (int z = 0; z < World_CHUNK_Z_SIZE; z++)
+        for (int x = 0; x < World_CHUNK_X_SIZE; x++)
+        {
+            const float gx = static_cast<float>(cx + x), gz = static_cast<float>(cz + z);
+
+            const int height = static_cast<int>(std::floor(128.0f + 40.0f * std::sin(gx * 0.021f) * std::cos(gz * 0.017f)));
+
+            heights[x + z * World_CHUNK_X_SIZE] = height;
+            max_height = std::max(max_height, height);
+        }
+
+        for (int y_base = 0; y_base <= max_height; y_base += World_CHUNK_SECTION_Y_SIZE)
+        {
+            Section section;
+            section.Heights = heights.data();
+            section.YBase   = y_base;
+
+            for (auto* samples : { &section.Cheese, &section.Spaghetti1, &section.Spaghetti2 }) samples->resize(SECTION_VOLUME);
+
+            for (int z = 0; z < World_CHUNK_Z_SIZE; z++)
+            for (int y = 0; y < World_CHUNK_SECTION_Y_SIZE; y++)
+            for (int x = 0; x < World_CHUNK_X_SIZE; x++)
+            {
+                const float gx = static_cast<float>(cx + x), gy = static_cast<float>(y_base + y), gz = static_cast<float>(cz + z);
+
+                const std::size_t i = static_cast<std::size_t>(x + World_CHUNK_X_SIZE * (y + World_CHUNK_SECTION_Y_SIZE * z));
+
+                section.Cheese[i]     = 0.9f * std::sin(gx * 0.09f + gy * 0.05f) * std::sin(gz * 0.08f - gy * 0.04f);
+                section.Spaghetti1[i] = 0.5f * std::sin(gx * 0.11f + gz * 0.03f + gy * 0.07f);
+                section.Spaghetti2[i] = 0.5f * std::cos(gz * 0.10f - gx * 0.04f + gy * 0.06f);
+            }
+
+            sections.push_back(std::move(section));
+        }
+    }
+
+    // Warm up, then time both.
+    std::vector<World_Block_ID> scalar_ids, kernel_ids;
+    std::vector<int>            scalar_tops, kernel_tops;
+
+    Run(sections, World_GenerationKernel_ClassifySection, kernel_ids, kernel_tops);
+
+    const double scalar_seconds = Run(sections, World_GenerationKernel_ClassifySection_Scalar, scalar_ids, scalar_tops);
+    const double kernel_seconds = Run(sections, World_GenerationKernel_ClassifySection, kernel_ids, kernel_tops);
+
+    std::size_t solid = 0;
+    for (World_Block_ID id : scalar_ids) solid += id != World_Block_ID::AIR;
+
+    const double blocks = static_cast<double>(sections.size()) * SECTION_VOLUME;
+
+    std::println("Generation kernel, {} sections, {:.1f}% solid blocks", sections.size(), 100.0 * static_cast<double>(solid) / blocks);
+    std::println("  scalar : {:6.2f} ns/block, {:7.1f} us/section", 1e9 * scalar_seconds / blocks, 1e6 * scalar_seconds / static_cast<double>(sections.size()));
+    std::println("  {:6} : {:6.2f} ns/block, {:7.1f} us/section ({:.1f}x)", World_GenerationKernel_GetInstructionSet(),
+        1e9 * kernel_seconds / blocks, 1e6 * kernel_seconds / static_cast<double>(sections.size()), scalar_seconds / kernel_seconds);
+
+    if (scalar_ids != kernel_ids || scalar_tops != kernel_tops)
+    {
+        std::println("Error: the kernel's output differs from the scalar reference.");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Chunk store order benchmark.
+// Times the generation, lighting and meshing kernels under the store order this binary was built with
+// (NITROCRAFT_CHUNK_STORE_ORDER, one executable per order, see CMakeLists.txt). Run them all to compare.
+
+#include <cstdint>
+#include <algorithm>
+#include <print>
+#include <queue>
+#include "Bench_Common.hpp"
+#include "Graphics_Mesh.hpp"
+#include "Utility_Timer.hpp"
+
+namespace
+{
+    constexpr int GRID_SIZE = 10;
+    constexpr int ROUNDS    = 3;
+
+    // Point lights seeded per inner chunk, just above the terrain.
+    constexpr int POINT_LIGHTS_PER_AXIS = 2;
+
+    constexpr const char* ToString(Array3DStoreOrder order)
+    {
+        switch (order)
+        {
+        case Array3DStoreOrder::XYZ:    return "XYZ";
+        case Array3DStoreOrder::XZY:    return "XZY";
+        case Array3DStoreOrder::YXZ:    return "YXZ";
+        case Array3DStoreOrder::YZX:    return "YZX";
+        case Array3DStoreOrder::ZXY:    return "ZXY";
+        case Array3DStoreOrder::ZYX:    return "ZYX";
+        case Array3DStoreOrder::MORTON: return "MORTON";
+        case Array3DStoreOrder::BRICK4: return "BRICK4";
+        }
+
+        return "?";
+    }
+
+    struct Timings
+    {
+        double Generation = 0.0;
+        double Sunlight   = 0.0;
+        double Pointlight = 0.0;
+        double Decode     = 0.0;
+        double Meshing    = 0.0;
+
+        std::uint64_t Checksum = 0;
+    };
+
+    void RunRound(Timings& timings)
+    {
+        Bench_ChunkGrid grid = Bench_AllocateChunkGrid(GRID_SIZE);
+
+        Timer timer;
+        for (auto& chunk : grid.Chunks) World_Generation_GenerateChunk(chunk.get());
+        timings.Generation += timer.Elapsed();
+
+        timer.Reset();
+        grid.ForEachInner([](World_Chunk* c) { World_Light_PropagateInitialSunlight(c); });
+        timings.Sunlight += timer.Elapsed();
+
+        std::queue<World_Light_LightAdditionNode> pointlight_add_queue;
+
+        timer.Reset();
+        grid.ForEachInner([&](World_Chunk* c)
+        {
+            for (int i = 0; i < POINT_LIGHTS_PER_AXIS; i++)
+            for (int j = 0; j < POINT_LIGHTS_PER_AXIS; j++)
+            {
+                const int lx = (2 * i + 1) * World_CHUNK_X_SIZE / (2 * POINT_LIGHTS_PER_AXIS);
+                const int lz = (2 * j + 1) * World_CHUNK_Z_SIZE / (2 * POINT_LIGHTS_PER_AXIS);
+                const int ly = std::min(c->GetHeightAt(lx, lz) + 1, World_CHUNK_Y_SIZE - 1);
+
+                c->SetPointlightAt(World_LocalXYZ(lx, ly, lz), World_LIGHT_LEVEL_POINT);
+                pointlight_add_queue.emplace(c, World_LocalXYZ(lx, ly, lz));
+            }
+
+            World_Light_PropagatePointlight(pointlight_add_queue);
+        });
+        timings.Pointlight += timer.Elapsed();
+
+        thread_local World_Chunk_PaddedBlockData blocks;
+
+        grid.ForEachInner([&](World_Chunk* c)
+        {
+            timer.Reset();
+            c->DecodePaddedBlocks(blocks);
+            timings.Decode += timer.Elapsed();
+
+            timer.Reset();
+            auto mesh = Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(c, blocks);
+            timings.Meshing += timer.Elapsed();
+
+            for (const auto& vertex : mesh.Vertices) timings.Checksum = timings.Checksum * 31 + vertex.L * 4 + vertex.AO;
+        });
+    }
+}
+
+int main()
+{
+    World_Generation_Initialize(1337);
+
+    Timings timings;
+
+    for (int r = 0; r < ROUNDS; r++) RunRound(timings);
+
+    const double chunks = static_cast<double>(GRID_SIZE * GRID_SIZE * ROUNDS);
+    const double inner  = static_cast<double>((GRID_SIZE - 2) * (GRID_SIZE - 2) * ROUNDS);
+
+    std::println("Store order {}, {} x {} chunks x {} rounds", ToString(World_CHUNK_STORE_ORDER), GRID_SIZE, GRID_SIZE, ROUNDS);
+    std::println("  generation       : {:.3f} ms/chunk", 1000.0 * timings.Generation / chunks);
+    std::println("  initial sunlight : {:.3f} ms/chunk", 1000.0 * timings.Sunlight / inner);
+    std::println("  point lights     : {:.3f} ms/chunk", 1000.0 * timings.Pointlight / inner);
+    std::println("  padded decode    : {:.3f} ms/chunk", 1000.0 * timings.Decode / inner);
+    std::println("  AO meshing       : {:.3f} ms/chunk", 1000.0 * timings.Meshing / inner);
+    std::println("  mesh checksum    : {}", timings.Checksum);
+
+    return 0;
+}
@@ -0,0 +1,515 @@
+// World streaming benchmark.
+// Runs the chunk manager and CPU meshing on the shared task scheduler without a window or a GL context, while a
+// scripted camera flies a straight line, a spiral, teleports, or replays a recorded trace. Reports per-stage throughput, how long the render area
+// takes to fill up, peak RSS and per-thread utilization.
+//
+// Usage: Nitrocraft_bench_streaming [--path line|spiral|teleport] [--speed blocks/s] [--render-distance chunks]
+//                                   [--duration seconds] [--teleport-interval seconds] [--workers count]
+//                                   [--replay trace_file] [--generation-region chunks]
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <numbers>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Bench_Common.hpp"
+#include "Graphics_Camera.hpp"
+#include "Graphics_Mesh.hpp"
+#include "World_ChunkManager.hpp"
+#include "World_Trace.hpp"
+#include "Utility_JobTelemetry.hpp"
+#include "Utility_TaskScheduler.hpp"
+#include "Utility_Time.hpp"
+#include "Utility_Timer.hpp"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    constexpr double FRAME_SECONDS      = 1.0 / 60.0;
+    constexpr float  VIEW_HALF_ANGLE    = 0.8f;
+    constexpr double SPIRAL_SPACING     = 4.0 * World_CHUNK_X_SIZE;    // Blocks between the spiral's turns
+    constexpr double TELEPORT_DISTANCE  = 4096.0 * World_CHUNK_X_SIZE; // Blocks between teleport destinations
+
+    enum class CameraPath
+    {
+        Line,
+        Spiral,
+        Teleport,
+        Replay,   // Frames of a trace recorded with Nitrocraft --record
+    };
+
+    struct Options
+    {
+        CameraPath  Path             = CameraPath::Line;
+        double      Speed            = 64.0; // Blocks per second, unused by the teleport path
+        std::size_t RenderDistance   = 12;
+        double      Duration         = 20.0;
+        double      TeleportInterval = 5.0;
+        std::size_t WorkerCount      = 0;    // 0 sizes the scheduler to the machine
+        std::size_t GenerationRegion = 0;    // 0 keeps the chunk manager's default
+        std::string ReplayTracePath;
+    };
+
+    std::optional<Options> ParseOptions(int argc, char** argv)
+    {
+        Options options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string_view key = argv[i];
+
+            if (i + 1 >= argc)
+            {
+                std::println("Error: {} expects a value.", key);
+                return std::nullopt;
+            }
+
+            const char* value = argv[++i];
+
+            if (key == "--path")
+            {
+                const std::string_view path = value;
+
+                if      (path == "line")     options.Path = CameraPath::Line;
+                else if (path == "spiral")   options.Path = CameraPath::Spiral;
+                else if (path == "teleport") options.Path = CameraPath::Teleport;
+                else
+                {
+                    std::println("Error: unknown path {}, expected line, spiral or teleport.", path);
+                    return std::nullopt;
+                }
+            }
+            else if (key == "--speed")             options.Speed            = std::atof(value);
+            else if (key == "--render-distance")   options.RenderDistance   = static_cast<std::size_t>(std::atoi(value));
+            else if (key == "--duration")          options.Duration         = std::atof(value);
+            else if (key == "--teleport-interval") options.TeleportInterval = std::atof(value);
+            else if (key == "--workers")           options.WorkerCount      = static_cast<std::size_t>(std::atoi(value));
+            else if (key == "--generation-region") options.GenerationRegion = static_cast<std::size_t>(std::atoi(value));
+            else if (key == "--replay")
+            {
+                options.Path            = CameraPath::Replay;
+                options.ReplayTracePath = value;
+            }
+            else
+            {
+                std::println("Error: unknown option {}.", key);
+                return std::nullopt;
+            }
+        }
+
+        return options;
+    }
+
+    const char* GetPathName(CameraPath path)
+    {
+        constexpr const char* names[4]{ "line", "spiral", "teleport", "replay" };
+
+        return names[static_cast<std::size_t>(path)];
+    }
+
+    // Horizontal camera position in blocks at time t.
+    glm::vec2 GetCameraPosition(const Options& options, double t)
+    {
+        switch (options.Path)
+        {
+        case CameraPath::Line:
+            return glm::vec2(static_cast<float>(options.Speed * t), 0.0f);
+
+        case CameraPath::Spiral:
+        {
+            // Archimedean spiral r = a * theta, its arc length is about a * theta^2 / 2 away from the center.
+            const double a     = SPIRAL_SPACING / (2.0 * std::numbers::pi);
+            const double theta = std::sqrt(2.0 * options.Speed * t / a);
+
+            return glm::vec2(static_cast<float>(a * theta * std::cos(theta)), static_cast<float>(a * theta * std::sin(theta)));
+        }
+
+        case CameraPath::Teleport:
+            return glm::vec2(static_cast<float>(std::floor(t / options.TeleportInterval) * TELEPORT_DISTANCE), 0.0f);
+
+        case CameraPath::Replay:
+            break;
+        }
+
+        return glm::vec2(0.0f);
+    }
+
+    // CPU meshing on the scheduler's workers, as Graphics_WorldRenderer does it minus the upload.
+    // Requests pin their chunk until the main thread takes them back with TakeCompleted_MainThread.
+    class StreamingMesher final : public TaskQueue
+    {
+    public:
+        struct Request
+        {
+            World_Chunk*  Chunk;
+            std::uint32_t Version;
+            double        EnqueueTime;
+            bool          Meshed;
+        };
+
+        void Request_MainThread(World_Chunk* chunk, std::uint32_t version)
+        {
+            chunk->PinCount().fetch_add(1, std::memory_order_relaxed);
+
+            m_Telemetry.Enqueued.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+
+            m_Pending.push_back(Request{ chunk, version, Time_GetTime(), false });
+            m_PendingSize.store(m_Pending.size(), std::memory_order_seq_cst);
+        }
+
+        std::vector<Request> TakeCompleted_MainThread()
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+
+            return std::exchange(m_Completed, {});
+        }
+
+        const JobTelemetry& GetTelemetry() const { return m_Telemetry; }
+
+        bool RunTask(std::size_t worker_index) override
+        {
+            (void)worker_index;
+
+            Request request;
+
+            {
+                std::lock_guard<std::mutex> lock{ m_Mutex };
+
+                if (m_Pending.empty()) return false;
+
+                request = m_Pending.front(); m_Pending.erase(m_Pending.begin());
+
+                m_PendingSize.store(m_Pending.size(), std::memory_order_relaxed);
+            }
+
+            const double start_time = Time_GetTime();
+
+            m_Telemetry.QueueWait.RecordSeconds(start_time - request.EnqueueTime);
+
+            std::optional<World_ChunkSnapshotView> view;
+
+            {
+                World_ChunkReadGuard guard;
+
+                if (request.Chunk->NeighboursSet().load(std::memory_order_seq_cst)) view = request.Chunk->TakeSnapshotView();
+            }
+
+            if (view)
+            {
+                Graphics_ChunkCPUMesh cpumesh = Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(*view);
+
+                Bench_DoNotOptimize(cpumesh);
+
+                request.Version = view->Center->Version;
+                request.Meshed  = true;
+
+                m_Telemetry.Executed.fetch_add(1, std::memory_order_relaxed);
+                m_Telemetry.Execution.RecordSeconds(Time_GetTime() - start_time);
+            }
+            else
+            {
+                m_Telemetry.Discarded.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+
+            m_Completed.push_back(request);
+
+            return true;
+        }
+
+        bool HasTasks() const override
+        {
+            return m_PendingSize.load(std::memory_order_seq_cst) != 0;
+        }
+
+    private:
+        std::vector<Request>     m_Pending;
+        std::atomic<std::size_t> m_PendingSize = 0;
+        std::vector<Request>     m_Completed;
+        std::mutex               m_Mutex;
+
+        JobTelemetry m_Telemetry;
+    };
+
+    // Peak resident set size in bytes, 0 where unsupported.
+    std::size_t GetPeakResidentSetSize()
+    {
+#if defined(__linux__) || defined(__APPLE__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    double Percentile(std::vector<double> samples, double p)
+    {
+        if (samples.empty()) return 0.0;
+
+        auto nth = samples.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), nth, samples.end());
+
+        return *nth;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options_opt = ParseOptions(argc, argv);
+
+    if (!options_opt.has_value())
+    {
+        std::println("Usage: {} [--path line|spiral|teleport] [--speed blocks/s] [--render-distance chunks] [--duration seconds] [--teleport-interval seconds] [--workers count] [--replay trace_file] [--generation-region chunks]", argv[0]);
+        return 1;
+    }
+
+    Options& options = options_opt.value();
+
+    std::vector<World_TraceFrame> trace_frames;
+
+    if (options.Path == CameraPath::Replay)
+    {
+        auto frames = World_Trace_Load(options.ReplayTracePath);
+
+        if (!frames.has_value() || frames->empty())
+        {
+            std::println("Error: failed to load trace {}.", options.ReplayTracePath);
+            return 1;
+        }
+
+        trace_frames     = std::move(frames.value());
+        options.Duration = trace_frames.back().Time + FRAME_SECONDS;
+    }
+
+    World_Generation_Initialize(1337);
+
+    TaskScheduler      scheduler{ options.WorkerCount };
+    World_ChunkManager manager{ scheduler };
+    StreamingMesher    mesher;
+
+    manager.SetRenderDistance(options.RenderDistance);
+
+    if (options.GenerationRegion != 0) manager.SetGenerationRegionSize(options.GenerationRegion);
+
+    scheduler.Register(TaskType::Meshing, mesher);
+
+    // Meshed (or requested) storage version of each loaded chunk, like the renderer's GPU mesh handles.
+    struct MeshState
+    {
+        std::uint32_t MeshedVersion    = 0;
+        std::uint32_t RequestedVersion = 0;
+    };
+
+    std::unordered_map<World_Chunk_ID, MeshState> mesh_states;
+
+    std::vector<double> populate_seconds;     // Time to mesh the whole render area, from the start and each teleport
+    std::vector<double> coverage_samples;     // Meshed fraction of the render area per frame, once first populated
+    double              populate_start = 0.0;
+    bool                populating     = true;
+    World_Chunk_ID      previous_center{ 0, 0, 0 };
+
+    double main_busy_seconds = 0.0;
+    int    frame_count       = 0;
+
+    Camera camera;
+
+    Timer total;
+    while (true)
+    {
+        const double t = total.Elapsed();
+
+        if (t >= options.Duration) break;
+
+        World_Chunk_ID center;
+        glm::vec3      view_direction;
+
+        if (options.Path == CameraPath::Replay)
+        {
+            // One recorded frame per frame, paced like Nitrocraft --replay.
+            if (static_cast<std::size_t>(frame_count) == trace_frames.size()) break;
+
+            const World_TraceFrame& frame = trace_frames[static_cast<std::size_t>(frame_count)];
+
+            if (frame.Time > t) std::this_thread::sleep_for(std::chrono::duration<double>(frame.Time - t));
+
+            camera.SetPose(frame.CameraPosition, frame.CameraYaw, frame.CameraPitch);
+
+            if (frame.RenderDistance != options.RenderDistance)
+            {
+                options.RenderDistance = frame.RenderDistance;
+                manager.SetRenderDistance(options.RenderDistance);
+            }
+
+            center         = World_FromGlobalToChunkID(World_GlobalXYZ(camera.GetPosition()));
+            view_direction = camera.GetFront();
+        }
+        else
+        {
+            const glm::vec2 position = GetCameraPosition(options, t);
+            const glm::vec2 ahead    = GetCameraPosition(options, t + 0.1) - position;
+
+            center         = World_FromGlobalToChunkID(World_GlobalXYZ{ static_cast<int>(std::floor(position.x)), 0, static_cast<int>(std::floor(position.y)) });
+            view_direction = glm::length(ahead) > 1e-4f ? glm::vec3(ahead.x, 0.0f, ahead.y) : glm::vec3(1.0f, 0.0f, 0.0f);
+        }
+
+        Timer frame_timer;
+
+        // A jump of more than the loading area restarts the population.
+        const int moved = std::max(std::abs(center.x - previous_center.x), std::abs(center.z - previous_center.z));
+
+        if (moved > static_cast<int>(2 * options.RenderDistance))
+        {
+            populate_start = t;
+            populating     = true;
+        }
+
+        previous_center = center;
+
+        manager.SetCenterChunk_MainThread(center, view_direction, VIEW_HALF_ANGLE);
+
+        for (const World_Chunk_ID& id : manager.TakeUnloadedChunkIDs_MainThread()) mesh_states.erase(id);
+
+        // Request meshes of renderable chunks, as Graphics_WorldRenderer::PrepareChunksToRender does.
+        const auto chunks = manager.GetChunksInRenderArea_MainThread();
+
+        std::size_t meshed = 0;
+
+        for (World_Chunk* chunk : chunks)
+        {
+            if (!chunk->IsNeighbourhoodLit()) continue;
+
+            MeshState& state = mesh_states[chunk->ID];
+
+            const std::uint32_t version = chunk->StorageVersion().load(std::memory_order_acquire);
+
+            if (state.MeshedVersion < version && state.RequestedVersion < version)
+            {
+                mesher.Request_MainThread(chunk, version);
+                state.RequestedVersion = version;
+            }
+
+            if (state.MeshedVersion != 0) meshed++;
+        }
+
+        scheduler.Notify();
+
+        for (const auto& completed : mesher.TakeCompleted_MainThread())
+        {
+            const bool retired = completed.Chunk->Retired().load(std::memory_order_acquire);
+
+            completed.Chunk->PinCount().fetch_sub(1, std::memory_order_release);
+
+            if (retired) continue;
+
+            auto iter = mesh_states.find(completed.Chunk->ID);
+
+            if (iter == mesh_states.end()) continue;
+
+            if (completed.Meshed)
+            {
+                iter->second.MeshedVersion = std::max(iter->second.MeshedVersion, completed.Version);
+            }
+            else if (iter->second.RequestedVersion == completed.Version)
+            {
+                iter->second.RequestedVersion = iter->second.MeshedVersion;
+            }
+        }
+
+        const double coverage = chunks.empty() ? 0.0 : static_cast<double>(meshed) / static_cast<double>(chunks.size());
+
+        if (!populate_seconds.empty()) coverage_samples.push_back(coverage);
+
+        if (populating && coverage >= 1.0)
+        {
+            populate_seconds.push_back(t - populate_start);
+            populating = false;
+        }
+
+        main_busy_seconds += frame_timer.Elapsed();
+        frame_count++;
+
+        const double remaining = FRAME_SECONDS - frame_timer.Elapsed();
+        if (remaining > 0.0 && options.Path != CameraPath::Replay) std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+    }
+    const double seconds = total.Elapsed();
+
+    scheduler.Unregister(TaskType::Meshing);
+
+    // Report
+    std::println("Streaming, path {}, speed {:.1f} blocks/s, render distance {}, generation region {}x{}, {:.1f}s, {} frames, {} workers",
+        GetPathName(options.Path), options.Speed, options.RenderDistance, manager.GetGenerationRegionSize(), manager.GetGenerationRegionSize(),
+        seconds, frame_count, scheduler.GetWorkerCount());
+
+    struct NamedTelemetry
+    {
+        const char*         Name;
+        const JobTelemetry* Telemetry;
+    };
+
+    const NamedTelemetry stages[]{
+        { "generation        ", &manager.GetJobTelemetry(World_ChunkManager::JobType::Generation) },
+        { "local lighting    ", &manager.GetJobTelemetry(World_ChunkManager::JobType::LocalLighting) },
+        { "neighbour lighting", &manager.GetJobTelemetry(World_ChunkManager::JobType::NeighbourLighting) },
+        { "meshing           ", &mesher.GetTelemetry() },
+    };
+
+    // Chunks completed by each stage, including the ones batched into other chunks' jobs.
+    for (const auto& [name, telemetry] : stages)
+    {
+        std::println("  {} : {:.1f} chunks/s, execution p50 {:.2f} ms, p99 {:.2f} ms, queue wait p50 {:.1f} ms, p99 {:.1f} ms",
+            name, static_cast<double>(telemetry->Executed.load() + telemetry->Batched.load()) / seconds,
+            telemetry->Execution.GetPercentile(0.5) * 1e-6, telemetry->Execution.GetPercentile(0.99) * 1e-6,
+            telemetry->QueueWait.GetPercentile(0.5) * 1e-6, telemetry->QueueWait.GetPercentile(0.99) * 1e-6);
+    }
+
+    if (populate_seconds.empty())
+    {
+        std::println("  render area populated : never");
+    }
+    else
+    {
+        std::println("  render area populated : {} times, first {:.2f}s, median {:.2f}s, max {:.2f}s",
+            populate_seconds.size(), populate_seconds.front(), Percentile(populate_seconds, 0.5), Percentile(populate_seconds, 1.0));
+    }
+
+    if (!coverage_samples.empty())
+    {
+        std::println("  render area meshed    : median {:.1f}%, min {:.1f}% of the frames since the first population",
+            100.0 * Percentile(coverage_samples, 0.5), 100.0 * Percentile(coverage_samples, 0.0));
+    }
+
+    std::println("  peak RSS              : {:.1f} MB", static_cast<double>(GetPeakResidentSetSize()) / (1024.0 * 1024.0));
+
+    std::println("  utilization           : main thread {:.1f}%", 100.0 * main_busy_seconds / seconds);
+
+    for (std::size_t i = 0; i < scheduler.GetWorkerCount(); i++)
+    {
+        const auto usage = scheduler.GetWorkerUsage(i);
+
+        std::println("    worker {:2} : {:5.1f}%, {} tasks", i, 100.0 * usage.BusySeconds / seconds, usage.TaskCount);
+    }
+
+    return 0;
+}
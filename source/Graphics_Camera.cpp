@@ -20,6 +20,19 @@ void Camera::Calculate(glm::vec3 delta_position, glm::vec2 delta_rotation)
     CalculateViewProjection();
 }
 
+void Camera::SetPose(glm::vec3 position, float yaw, float pitch)
+{
+    m_Position = position;
+    m_Yaw = yaw;
+    m_Pitch = pitch;
+
+    CalculateRotation(glm::vec2(0.0f));
+
+    CalculateView();
+
+    CalculateViewProjection();
+}
+
 void Camera::SetFovY(float fovy)
 {
     m_FovY = fovy;
@@ -12,8 +12,14 @@ public:
 
     void Calculate(glm::vec3 delta_position, glm::vec2 delta_rotation);
 
+    // Places the camera directly, as replays do. Angles in radians.
+    void SetPose(glm::vec3 position, float yaw, float pitch);
+
     glm::vec3 GetPosition() const { return m_Position; }
 
+    float GetYaw()   const { return m_Yaw; }
+    float GetPitch() const { return m_Pitch; }
+
     glm::vec3 GetRight() const { return m_Right; }
     glm::vec3 GetLeft()  const { return -m_Right; }
     glm::vec3 GetUp()    const { return m_Up; }
@@ -21,6 +27,9 @@ public:
     glm::vec3 GetFront() const { return m_Front; }
     glm::vec3 GetBack()  const { return -m_Front; }
 
+    float GetFovY()        const { return m_FovY; }
+    float GetAspectRatio() const { return m_AspectRatio; }
+
     const glm::mat4& GetView()           const { return m_View; }
     const glm::mat4& GetProjection()     const { return m_Projection; }
     const glm::mat4& GetViewProjection() const { return m_ViewProjection; }
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <array>
+#include <bit>
+#include <tuple>
 #include <glm/vec2.hpp>
 #include "World_Coordinate.hpp"
 #include "World_Chunk.hpp"
@@ -82,24 +84,96 @@ namespace
         { TI(10,0), TI(10,0), TI(10,0), TI(10,0), TI(10,0), TI(10,0) }, // Oak Leaves
         { TI(11,0), TI(11,0), TI(11,0), TI(11,0), TI(11,0), TI(11,0) }, // Oak Wood
     };
+
+    // Calls f(lx, ly, lz) for every block that may have a visible face, found 64 blocks at a time from the opacity masks:
+    // opaque blocks not enclosed by opaque blocks, and every block not opaque of sections holding non-air transparent blocks.
+    // Air is left to the caller to skip.
+    template<typename F>
+    void ForEachExposedBlock(const World_ChunkNeighbourhood& area, F&& f)
+    {
+        constexpr int WORD_COUNT        = static_cast<int>(std::tuple_size_v<World_Chunk_OpacityColumn>);
+        constexpr int SECTIONS_PER_WORD = 64 / World_CHUNK_SECTION_Y_SIZE;
+
+        thread_local World_Chunk_PaddedOpacityData opacity;
+
+        area.DecodePaddedOpacity(opacity);
+
+        World_Chunk_OpacityColumn transparent{};
+
+        for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+        {
+            if (area.Center->SectionHasTransparentBlocks(s)) transparent[s / SECTIONS_PER_WORD] |= std::uint64_t{ 0xFFFF } << (World_CHUNK_SECTION_Y_SIZE * (s % SECTIONS_PER_WORD));
+        }
+
+        for (int lz = 0; lz < World_CHUNK_Z_SIZE; lz++)
+        for (int lx = 0; lx < World_CHUNK_X_SIZE; lx++)
+        {
+            const auto& c  = opacity.At(lx + 1, lz + 1);
+            const auto& xn = opacity.At(lx,     lz + 1);
+            const auto& xp = opacity.At(lx + 2, lz + 1);
+            const auto& zn = opacity.At(lx + 1, lz);
+            const auto& zp = opacity.At(lx + 1, lz + 2);
+
+            for (int w = 0; w < WORD_COUNT; w++)
+            {
+                // Opacity of the blocks below and above, outside the chunk is air.
+                const std::uint64_t yn = (c[w] << 1) | ((w > 0)              ? c[w - 1] >> 63 : 0);
+                const std::uint64_t yp = (c[w] >> 1) | ((w < WORD_COUNT - 1) ? c[w + 1] << 63 : 0);
+
+                const std::uint64_t enclosed = xn[w] & xp[w] & zn[w] & zp[w] & yn & yp;
+
+                std::uint64_t candidates = (c[w] & ~enclosed) | (~c[w] & transparent[w]);
+
+                while (candidates != 0)
+                {
+                    f(lx, w * 64 + std::countr_zero(candidates), lz);
+
+                    candidates &= candidates - 1;
+                }
+            }
+        }
+    }
 }
 
 Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chunk)
+{
+    thread_local World_Chunk_PaddedBlockData blocks;
+
+    const World_ChunkNeighbourhood area = chunk->GetNeighbourhood();
+
+    area.DecodePaddedBlocks(blocks);
+
+    return Graphics_Mesh_GenerateChunkCPUMesh(chunk, area, blocks);
+}
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_ChunkSnapshotView& view)
+{
+    thread_local World_Chunk_PaddedBlockData blocks;
+
+    view.Area.DecodePaddedBlocks(blocks);
+
+    return Graphics_Mesh_GenerateChunkCPUMesh(view.Chunk, view.Area, blocks);
+}
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chunk, const World_Chunk_PaddedBlockData& blocks)
+{
+    return Graphics_Mesh_GenerateChunkCPUMesh(chunk, chunk->GetNeighbourhood(), blocks);
+}
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chunk, const World_ChunkNeighbourhood& area, const World_Chunk_PaddedBlockData& blocks)
 {
     Graphics_ChunkCPUMesh cpumesh{ const_cast<World_Chunk*>(chunk) };
 
     World_GlobalXYZ chunk_offset = World_FromChunkIDToChunkOffset(chunk->ID);
 
-    for (int lz = 0; lz < World_CHUNK_Z_SIZE; lz++)
-    for (int lx = 0; lx < World_CHUNK_X_SIZE; lx++)
-    for (int ly = 0; ly < World_CHUNK_Y_SIZE; ly++)
+    ForEachExposedBlock(area, [&](int lx, int ly, int lz)
     {
         // Block face detection
-        World_Block block = chunk->GetBlockAt(World_LocalXYZ(lx, ly, lz));
+        World_Block block = blocks.At(lx + 1, ly + 1, lz + 1);
 
-        if (block.ID == World_Block_ID::AIR) continue;
+        if (block.ID == World_Block_ID::AIR) return;
 
-        auto neighbour_blocks = chunk->GetWholeNeighbourBlocksAt(World_LocalXYZ(lx, ly, lz));
+        auto neighbour_blocks = World_Chunk_GetWholeNeighbourBlocksAt(blocks, World_LocalXYZ(lx, ly, lz));
 
         std::uint32_t blockface_bitmask = 0;
 
@@ -108,12 +182,12 @@ Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chun
             if (neighbour_blocks[face].IsTransparent()) blockface_bitmask |= (1u << (std::uint32_t)face);
         }
 
-        if (blockface_bitmask == 0) continue;
+        if (blockface_bitmask == 0) return;
 
         // Chunk Mesh generation
         World_GlobalXYZ block_offset = chunk_offset + World_GlobalXYZ(lx, ly, lz);
 
-        auto neighbour_lights = chunk->GetCrossNeighbourLightsAt(World_LocalXYZ(lx, ly, lz));
+        auto neighbour_lights = area.GetCrossNeighbourLightsAt(World_LocalXYZ(lx, ly, lz));
 
         for (std::size_t face = (std::size_t)World_Block_Face::XN; face <= (std::size_t)World_Block_Face::ZP; face++)
         {
@@ -151,7 +225,7 @@ Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chun
                 }
             );
         }
-    }
+    });
 
     return cpumesh;
 }
@@ -226,21 +300,44 @@ namespace
 }
 
 Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_Chunk* chunk)
+{
+    thread_local World_Chunk_PaddedBlockData blocks;
+
+    const World_ChunkNeighbourhood area = chunk->GetNeighbourhood();
+
+    area.DecodePaddedBlocks(blocks);
+
+    return Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(chunk, area, blocks);
+}
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_ChunkSnapshotView& view)
+{
+    thread_local World_Chunk_PaddedBlockData blocks;
+
+    view.Area.DecodePaddedBlocks(blocks);
+
+    return Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(view.Chunk, view.Area, blocks);
+}
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_Chunk* chunk, const World_Chunk_PaddedBlockData& blocks)
+{
+    return Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(chunk, chunk->GetNeighbourhood(), blocks);
+}
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_Chunk* chunk, const World_ChunkNeighbourhood& area, const World_Chunk_PaddedBlockData& blocks)
 {
     Graphics_ChunkCPUMesh cpumesh{ const_cast<World_Chunk*>(chunk) };
 
     World_GlobalXYZ chunk_offset = World_FromChunkIDToChunkOffset(chunk->ID);
 
-    for (int lz = 0; lz < World_CHUNK_Z_SIZE; lz++)
-    for (int lx = 0; lx < World_CHUNK_X_SIZE; lx++)
-    for (int ly = 0; ly < World_CHUNK_Y_SIZE; ly++)
+    ForEachExposedBlock(area, [&](int lx, int ly, int lz)
     {
         // Block face detection
-        World_Block block = chunk->GetBlockAt(World_LocalXYZ(lx, ly, lz));
+        World_Block block = blocks.At(lx + 1, ly + 1, lz + 1);
 
-        if (block.ID == World_Block_ID::AIR) continue;
+        if (block.ID == World_Block_ID::AIR) return;
 
-        auto neighbour_blocks = chunk->GetWholeNeighbourBlocksAt(World_LocalXYZ(lx, ly, lz));
+        auto neighbour_blocks = World_Chunk_GetWholeNeighbourBlocksAt(blocks, World_LocalXYZ(lx, ly, lz));
 
         std::uint32_t blockface_bitmask = 0;
 
@@ -249,12 +346,12 @@ Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const
             if (neighbour_blocks[face].IsTransparent()) blockface_bitmask |= (1u << (std::uint32_t)face);
         }
 
-        if (blockface_bitmask == 0) continue;
+        if (blockface_bitmask == 0) return;
 
         // Chunk mesh generation
         World_GlobalXYZ block_offset = chunk_offset + World_GlobalXYZ(lx, ly, lz);
 
-        auto neighbour_lights = chunk->GetCrossNeighbourLightsAt(World_LocalXYZ(lx, ly, lz));
+        auto neighbour_lights = area.GetCrossNeighbourLightsAt(World_LocalXYZ(lx, ly, lz));
 
         for (std::size_t face = (std::size_t)World_Block_Face::XN; face <= (std::size_t)World_Block_Face::ZP; face++)
         {
@@ -323,7 +420,7 @@ Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const
                 );
             }
         }
-    }
+    });
 
     return cpumesh;
 }
@@ -5,8 +5,7 @@
 #include <vector>
 #include <atomic>
 #include <glad/gl.h>
-
-struct World_Chunk;
+#include "World_Chunk.hpp"
 
 struct Graphics_ChunkMeshVertexLayout
 {
@@ -28,10 +27,26 @@ struct Graphics_ChunkCPUMesh
     std::vector<std::uint32_t>                  Indices;
 };
 
+// Chunk must have its neighbours set. Blocks are bulk decoded with a one block apron before meshing.
 Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chunk);
 
 Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_Chunk* chunk);
 
+// Meshes from snapshots, safe against concurrent writes to the chunks.
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_ChunkSnapshotView& view);
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_ChunkSnapshotView& view);
+
+// Meshes from already decoded blocks. Lights are still read from the chunk.
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chunk, const World_Chunk_PaddedBlockData& blocks);
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_Chunk* chunk, const World_Chunk_PaddedBlockData& blocks);
+
+// Same, with lights and opacity read from area (the storages of chunk and its neighbours).
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh(const World_Chunk* chunk, const World_ChunkNeighbourhood& area, const World_Chunk_PaddedBlockData& blocks);
+
+Graphics_ChunkCPUMesh Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(const World_Chunk* chunk, const World_ChunkNeighbourhood& area, const World_Chunk_PaddedBlockData& blocks);
+
 struct Graphics_ChunkGPUMeshHandle
 {
     GLuint        VertexArrayID;
@@ -17,7 +17,7 @@
 #include <unordered_map>
 #include <print>
 
-void Graphics_WorldRenderer::Initialize()
+void Graphics_WorldRenderer::Initialize(TaskScheduler& scheduler)
 {
     // Load shader program
     auto vshader_source_opt = IO_ReadFile("resource/shader/Chunk.vert.glsl");
@@ -65,35 +65,15 @@ void Graphics_WorldRenderer::Initialize()
 
     m_BlockTextureAtlas = texture;
 
-    // Start meshing worker threads
-    m_MeshingThreadCount = std::clamp<std::size_t>(std::max(1u, std::thread::hardware_concurrency()) / 2, 1u, 8u);
-
-    m_MeshingThreads.reserve(m_MeshingThreadCount);
-
-    for (std::size_t i = 0; i < m_MeshingThreadCount; i++)
-    {
-        m_MeshingThreads.emplace_back(
-            [this]()
-            {
-                this->CPUMeshingWorkLoop();
-            }
-        );
-    }
+    // Meshing jobs are run by the scheduler's workers
+    m_Scheduler = &scheduler;
+    m_Scheduler->Register(TaskType::Meshing, *this);
 }
 
 void Graphics_WorldRenderer::Terminate()
 {
-    {
-        std::lock_guard<std::mutex> lock{ m_MeshingJobMutex };
-        m_MeshingJobRetire = true;
-    }
-    m_MeshingJobCond.notify_all();
-
-    for (auto& t : m_MeshingThreads)
-    {
-        if (t.joinable()) t.join();
-    }
-    m_MeshingThreads.clear();
+    if (m_Scheduler != nullptr) m_Scheduler->Unregister(TaskType::Meshing);
+    m_Scheduler = nullptr;
 
     m_ChunkGPUMeshHandles.clear();
 
@@ -149,17 +129,18 @@ void Graphics_WorldRenderer::PrepareChunksToRender(const std::vector<World_Chunk
     // Queue missing chunk cpu mesh
     for (auto chunk : chunks_in_render_area)
     {
-        if (chunk->Stage.load(std::memory_order_acquire) < World_Chunk_Stage::NeighbourLightingComplete) continue;
+        // Meshes read the neighbours' snapshots, published once they complete neighbour lighting.
+        if (!chunk->IsNeighbourhoodLit()) continue;
 
         m_GPUMeshIDsToRender.emplace_back(chunk->ID);
 
-        auto chunk_storage_version = chunk->StorageVersion.load(std::memory_order_acquire);
+        auto chunk_storage_version = chunk->StorageVersion().load(std::memory_order_acquire);
 
         GPUMeshHandleHolder* holder = nullptr;
 
         if (auto iter = m_ChunkGPUMeshHandles.find(chunk->ID); iter == m_ChunkGPUMeshHandles.end())
         {
-            auto [new_iter, res] = m_ChunkGPUMeshHandles.emplace(chunk->ID, GPUMeshHandleHolder{ std::make_unique<Graphics_ChunkGPUMeshHandle>(), 0, 0});
+            auto [new_iter, res] = m_ChunkGPUMeshHandles.emplace(chunk->ID, GPUMeshHandleHolder{ std::make_unique<Graphics_ChunkGPUMeshHandle>(), 0, 0, false });
             holder = &new_iter->second;
         }
         else
@@ -170,16 +151,50 @@ void Graphics_WorldRenderer::PrepareChunksToRender(const std::vector<World_Chunk
         if (holder->UploadedVersion < chunk_storage_version && holder->RequestedVersion < chunk_storage_version)
         {
             // Push to mesh gen queue
+            chunk->PinCount().fetch_add(1, std::memory_order_relaxed);
+
+            m_MeshingTelemetry.Enqueued.fetch_add(1, std::memory_order_relaxed);
+
+            if (holder->RequestSkipped)
+            {
+                m_MeshingTelemetry.Requeued.fetch_add(1, std::memory_order_relaxed);
+                holder->RequestSkipped = false;
+            }
+
             {
                 std::lock_guard<std::mutex> lock{ m_MeshingJobMutex };
-                m_MeshingJobQueue.emplace(chunk, chunk_storage_version);
+                m_MeshingJobQueue.emplace(chunk, chunk_storage_version, Time_GetTime());
+                m_MeshingJobQueueSize.store(m_MeshingJobQueue.size(), std::memory_order_seq_cst);
             }
-            m_MeshingJobCond.notify_one();
+            m_Scheduler->Notify();
 
             holder->RequestedVersion = chunk_storage_version;
         }
     }
 
+    // Release skipped meshing jobs, their chunks get requested again while the version is not uploaded.
+    while (true)
+    {
+        MeshingJob skipped;
+
+        {
+            std::lock_guard<std::mutex> lock{ m_CompletedCPUMeshQueueMutex };
+
+            if (m_SkippedMeshingJobQueue.empty()) break;
+
+            skipped = m_SkippedMeshingJobQueue.front(); m_SkippedMeshingJobQueue.pop();
+        }
+
+        if (auto iter = m_ChunkGPUMeshHandles.find(skipped.MeshingChunk->ID); iter != m_ChunkGPUMeshHandles.end())
+        {
+            if (iter->second.RequestedVersion == skipped.RequestVersion) iter->second.RequestedVersion = iter->second.UploadedVersion;
+
+            iter->second.RequestSkipped = true;
+        }
+
+        skipped.MeshingChunk->PinCount().fetch_sub(1, std::memory_order_release);
+    }
+
     // Upload completed mesh to gpu
     while (true)
     {
@@ -194,18 +209,24 @@ void Graphics_WorldRenderer::PrepareChunksToRender(const std::vector<World_Chunk
             cpumesh = std::move(m_CompletedCPUMeshQueue.front()); m_CompletedCPUMeshQueue.pop();
         }
 
-        if (cpumesh.MeshedChunk->StorageVersion.load(std::memory_order_acquire) > cpumesh.CompletedVersion) continue;
+        const bool retired = cpumesh.MeshedChunk->Retired().load(std::memory_order_acquire);
+
+        cpumesh.MeshedChunk->PinCount().fetch_sub(1, std::memory_order_release);
 
-        // Upload finished cpumesh to gpu if its version is > gpu mesh version.
+        if (retired) continue;
+
+        // Upload finished cpumesh to gpu unless its version is < gpu mesh version.
+        // Meshes of a snapshot older than requested are still uploaded, the newer version stays requested.
         auto iter = m_ChunkGPUMeshHandles.find(cpumesh.MeshedChunk->ID);
 
         if (iter == m_ChunkGPUMeshHandles.end()) continue;
 
         auto& holder = iter->second;
 
-        if (cpumesh.CompletedVersion != holder.RequestedVersion) continue;
+        if (cpumesh.CompletedVersion < holder.UploadedVersion) continue;
 
-        holder.UploadedVersion = holder.RequestedVersion;
+        holder.UploadedVersion  = cpumesh.CompletedVersion;
+        holder.RequestedVersion = std::max(holder.RequestedVersion, holder.UploadedVersion);
 
         glBindBuffer(GL_ARRAY_BUFFER, holder.Handle->VertexBufferID);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, holder.Handle->IndexBufferID);
@@ -220,38 +241,80 @@ void Graphics_WorldRenderer::PrepareChunksToRender(const std::vector<World_Chunk
     }
 }
 
-void Graphics_WorldRenderer::CPUMeshingWorkLoop()
+void Graphics_WorldRenderer::EvictChunks(const std::vector<World_Chunk_ID>& unloaded_chunk_ids)
 {
-    while (true)
+    for (const auto& id : unloaded_chunk_ids)
     {
-        World_Chunk*  chunk = nullptr;
-        std::uint32_t request_version = 0;
+        m_ChunkGPUMeshHandles.erase(id);
+    }
+}
 
-        {
-            std::unique_lock<std::mutex> lock{ m_MeshingJobMutex };
+bool Graphics_WorldRenderer::RunTask(std::size_t worker_index)
+{
+    (void)worker_index;
 
-            m_MeshingJobCond.wait(lock, [this]() { return m_MeshingJobRetire || !m_MeshingJobQueue.empty(); });
+    World_Chunk*  chunk = nullptr;
+    std::uint32_t request_version = 0;
+    double        enqueue_time = 0.0;
 
-            if (m_MeshingJobRetire) return;
+    {
+        std::lock_guard<std::mutex> lock{ m_MeshingJobMutex };
 
-            auto [c,v] = m_MeshingJobQueue.front(); m_MeshingJobQueue.pop();
-            chunk = c;
-            request_version = v;
-        }
+        if (m_MeshingJobQueue.empty()) return false;
 
-        if (request_version < chunk->StorageVersion.load(std::memory_order_acquire)) continue;
+        auto [c,v,t] = m_MeshingJobQueue.front(); m_MeshingJobQueue.pop();
+        chunk = c;
+        request_version = v;
+        enqueue_time = t;
 
-        auto cpumesh =
-            (m_EnableAmbientOcclusion) ?
-            Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(chunk) :
-            Graphics_Mesh_GenerateChunkCPUMesh(chunk);
+        m_MeshingJobQueueSize.store(m_MeshingJobQueue.size(), std::memory_order_relaxed);
+    }
 
-        cpumesh.CompletedVersion = request_version;
+    const double start_time = Time_GetTime();
 
-        {
-            std::lock_guard<std::mutex> lock{ m_CompletedCPUMeshQueueMutex };
+    m_MeshingTelemetry.QueueWait.RecordSeconds(start_time - enqueue_time);
 
-            m_CompletedCPUMeshQueue.emplace(std::move(cpumesh));
-        }
+    std::optional<World_ChunkSnapshotView> view;
+
+    {
+        World_ChunkReadGuard guard;
+
+        // Chunks being unloaded, or next to one, lose their neighbour pointers.
+        if (chunk->NeighboursSet().load(std::memory_order_seq_cst)) view = chunk->TakeSnapshotView();
     }
+
+    if (!view)
+    {
+        m_MeshingTelemetry.Discarded.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock{ m_CompletedCPUMeshQueueMutex };
+
+        m_SkippedMeshingJobQueue.emplace(chunk, request_version, enqueue_time);
+
+        return true;
+    }
+
+    // Snapshots are immutable, writers publish newer versions instead of invalidating this mesh.
+    Graphics_ChunkCPUMesh cpumesh =
+        (m_EnableAmbientOcclusion) ?
+        Graphics_Mesh_GenerateChunkCPUMesh_AmbientOcclusion(*view) :
+        Graphics_Mesh_GenerateChunkCPUMesh(*view);
+
+    cpumesh.CompletedVersion = view->Center->Version;
+
+    m_MeshingTelemetry.Executed.fetch_add(1, std::memory_order_relaxed);
+    m_MeshingTelemetry.Execution.RecordSeconds(Time_GetTime() - start_time);
+
+    {
+        std::lock_guard<std::mutex> lock{ m_CompletedCPUMeshQueueMutex };
+
+        m_CompletedCPUMeshQueue.emplace(std::move(cpumesh));
+    }
+
+    return true;
+}
+
+bool Graphics_WorldRenderer::HasTasks() const
+{
+    return m_MeshingJobQueueSize.load(std::memory_order_seq_cst) != 0;
 }
@@ -2,30 +2,39 @@
 
 #include <utility>
 #include <vector>
-#include <thread>
+#include <queue>
+#include <mutex>
 #include <atomic>
-#include <condition_variable>
 #include "Graphics_Shader.hpp"
 #include "Graphics_Mesh.hpp"
 #include "World_Coordinate.hpp"
 #include "World_ChunkManager.hpp"
+#include "Utility_TaskScheduler.hpp"
+#include "Utility_JobTelemetry.hpp"
 
 class Camera;
 struct World_Chunk;
 
-class Graphics_WorldRenderer
+// Meshing runs on the scheduler's workers as TaskType::Meshing tasks.
+class Graphics_WorldRenderer : private TaskQueue
 {
 public:
     Graphics_WorldRenderer() = default;
     ~Graphics_WorldRenderer() = default;
 
-    void Initialize();
+    void Initialize(TaskScheduler& scheduler);
     void Terminate();
 
     void Render(const Camera& camera, float sunlight_intensity, glm::vec3 sky_color);
 
     void PrepareChunksToRender(const std::vector<World_Chunk*>& chunks_in_render_area);
 
+    // Drops GPU meshes of chunks unloaded by the chunk manager.
+    void EvictChunks(const std::vector<World_Chunk_ID>& unloaded_chunk_ids);
+
+    const JobTelemetry& GetMeshingTelemetry()       const { return m_MeshingTelemetry; }
+    std::size_t         GetQueuedMeshingJobCount()  const { return m_MeshingJobQueueSize.load(std::memory_order_relaxed); }
+
     void EnableAmbientOcclusion(bool enable)
     {
         static bool prev_enable = m_EnableAmbientOcclusion;
@@ -56,6 +65,7 @@ private:
         std::unique_ptr<Graphics_ChunkGPUMeshHandle> Handle;
         std::uint32_t UploadedVersion = 0;
         std::uint32_t RequestedVersion = 0;
+        bool          RequestSkipped = false; // Last meshing job was skipped, telemetry counts the next one as requeued.
     };
 
     bool m_EnableAmbientOcclusion = true;
@@ -63,23 +73,27 @@ private:
     std::vector<World_Chunk_ID> m_GPUMeshIDsToRender;
     std::unordered_map<World_Chunk_ID, GPUMeshHandleHolder> m_ChunkGPUMeshHandles;
 
-    // Meshing threads
-    std::vector<std::jthread>  m_MeshingThreads;
-    std::size_t                m_MeshingThreadCount = 0;
+    TaskScheduler* m_Scheduler = nullptr;
 
     // Meshing job
+    // Meshing jobs pin their chunk until the main thread consumes the completed mesh or the skipped job.
     struct MeshingJob
     {
         World_Chunk*  MeshingChunk;
         std::uint32_t RequestVersion;
+        double        EnqueueTime = 0.0;
     };
-    std::queue<MeshingJob>  m_MeshingJobQueue;
-    bool                    m_MeshingJobRetire = false;
-    std::mutex              m_MeshingJobMutex;
-    std::condition_variable m_MeshingJobCond;
+    std::queue<MeshingJob>   m_MeshingJobQueue;
+    std::atomic<std::size_t> m_MeshingJobQueueSize = 0;
+    std::mutex               m_MeshingJobMutex;
+
+    JobTelemetry m_MeshingTelemetry;
 
     std::queue<Graphics_ChunkCPUMesh> m_CompletedCPUMeshQueue;
+    std::queue<MeshingJob>            m_SkippedMeshingJobQueue;
     std::mutex                        m_CompletedCPUMeshQueueMutex;
 
-    void CPUMeshingWorkLoop();
+    // TaskQueue, meshes one job per task. Called from scheduler workers.
+    bool RunTask(std::size_t worker_index) override;
+    bool HasTasks() const override;
 };
@@ -1,8 +1,27 @@
 #include "Nitrocraft.hpp"
 
-int main()
+#include <print>
+#include <string_view>
+
+int main(int argc, char** argv)
 {
-    Nitrocraft_Run();
+    Nitrocraft_Options options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view arg = argv[i];
+
+        if      (arg == "--record" && i + 1 < argc) options.RecordTracePath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) options.ReplayTracePath = argv[++i];
+        else if (arg == "--cave-lattice")           options.CaveLattice = true;
+        else
+        {
+            std::println("Usage: {} [--record trace_file] [--replay trace_file] [--cave-lattice]", argv[0]);
+            return 1;
+        }
+    }
+
+    Nitrocraft_Run(options);
 
     return 0;
 }
@@ -1,17 +1,28 @@
 #include "Nitrocraft.hpp"
 
+#include <cstdio>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <print>
+#include <thread>
+#include <vector>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include "World.hpp"
+#include "World_Generation.hpp"
+#include "World_Trace.hpp"
 #include "Graphics_BlockOutlineRenderer.hpp"
 #include "Graphics_WorldRenderer.hpp"
 #include "Graphics_Camera.hpp"
 #include "Utility_Time.hpp"
 #include "Utility_Timer.hpp"
+#include "Utility_TaskScheduler.hpp"
 
 namespace
 {
@@ -28,6 +39,13 @@ float PlayerSpeed = 20.0f;
 
 int RenderDistance = 6;
 
+int WorldSeed = 12345;
+
+// Worker threads shared by chunk generation, lighting and meshing. 0 sizes them to the machine.
+std::size_t WorkerThreadCount = 0;
+
+std::unique_ptr<TaskScheduler> Scheduler;
+
 Graphics_WorldRenderer WorldRenderer;
 
 GLFWwindow* InitializeGLFWAndOpenGLContext()
@@ -205,9 +223,204 @@ void ImGUI_Render()
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     // (Your code calls glfwSwapBuffers() etc.)
 }
+
+// Job system telemetry, sampled every frame while its window is open.
+struct JobTelemetrySample
+{
+    double                                                         Time = 0.0;
+    std::size_t                                                    QueuedChunkJobs = 0;
+    std::size_t                                                    QueuedMeshingJobs = 0;
+    std::array<std::size_t, (std::size_t)World_Chunk_Stage::COUNT> StageCounts{};
+};
+
+constexpr std::size_t JOB_TELEMETRY_SAMPLE_CAPACITY = 1200;
+
+std::deque<JobTelemetrySample> JobTelemetrySamples;
+
+constexpr const char* JOB_NAMES[4]{ "Generation", "Local Lighting", "Neighbour Lighting", "Meshing" };
+
+constexpr const char* STAGE_NAMES[(std::size_t)World_Chunk_Stage::COUNT]{
+    "Empty", "Generation In Progress", "Generation Complete", "Local Lighting In Progress", "Local Lighting Complete",
+    "Neighbour Lighting In Progress", "Neighbour Lighting Complete" };
+
+std::array<const JobTelemetry*, 4> GetJobTelemetries()
+{
+    const World_ChunkManager& manager = World_GetChunkManager();
+
+    return {
+        &manager.GetJobTelemetry(World_ChunkManager::JobType::Generation),
+        &manager.GetJobTelemetry(World_ChunkManager::JobType::LocalLighting),
+        &manager.GetJobTelemetry(World_ChunkManager::JobType::NeighbourLighting),
+        &WorldRenderer.GetMeshingTelemetry() };
+}
+
+// Writes the job telemetry table and the recorded samples, returns false if either file couldn't be opened.
+bool DumpJobTelemetryCSV(const char* jobs_path, const char* samples_path)
+{
+    FILE* jobs = std::fopen(jobs_path, "w");
+    if (jobs == nullptr) return false;
+
+    std::println(jobs, "job,enqueued,requeued,executed,discarded,batched,wait_mean_us,wait_p50_us,wait_p99_us,wait_max_us,exec_mean_us,exec_p50_us,exec_p99_us,exec_max_us");
+
+    const auto telemetries = GetJobTelemetries();
+
+    for (std::size_t i = 0; i < telemetries.size(); i++)
+    {
+        const JobTelemetry& t = *telemetries[i];
+
+        std::println(jobs, "{},{},{},{},{},{},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f}", JOB_NAMES[i],
+            t.Enqueued.load(), t.Requeued.load(), t.Executed.load(), t.Discarded.load(), t.Batched.load(),
+            t.QueueWait.GetMean() * 1e-3, t.QueueWait.GetPercentile(0.5) * 1e-3, t.QueueWait.GetPercentile(0.99) * 1e-3, t.QueueWait.GetMax() * 1e-3,
+            t.Execution.GetMean() * 1e-3, t.Execution.GetPercentile(0.5) * 1e-3, t.Execution.GetPercentile(0.99) * 1e-3, t.Execution.GetMax() * 1e-3);
+    }
+
+    std::fclose(jobs);
+
+    FILE* samples = std::fopen(samples_path, "w");
+    if (samples == nullptr) return false;
+
+    std::print(samples, "time,queued_chunk_jobs,queued_meshing_jobs");
+    for (const char* name : STAGE_NAMES) std::print(samples, ",{}", name);
+    std::println(samples, "");
+
+    for (const auto& sample : JobTelemetrySamples)
+    {
+        std::print(samples, "{:.4f},{},{}", sample.Time, sample.QueuedChunkJobs, sample.QueuedMeshingJobs);
+        for (std::size_t count : sample.StageCounts) std::print(samples, ",{}", count);
+        std::println(samples, "");
+    }
+
+    std::fclose(samples);
+
+    return true;
+}
+
+void ImGUI_JobTelemetryWindow()
+{
+    if (!ImGui::Begin("Job Telemetry"))
+    {
+        ImGui::End();
+        return;
+    }
+
+    // Sample
+    const World_ChunkManager& manager = World_GetChunkManager();
+
+    JobTelemetrySamples.push_back(JobTelemetrySample{ Time_GetTime(), manager.GetQueuedJobCount(), WorldRenderer.GetQueuedMeshingJobCount(), manager.GetChunkStageCounts() });
+
+    if (JobTelemetrySamples.size() > JOB_TELEMETRY_SAMPLE_CAPACITY) JobTelemetrySamples.pop_front();
+
+    // Per job type
+    if (ImGui::BeginTable("##jobs", 10, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        for (const char* column : { "Job", "Enqueued", "Requeued", "Executed", "Discarded", "Batched", "Wait P50", "Wait P99", "Exec P50", "Exec P99" })
+        {
+            ImGui::TableSetupColumn(column);
+        }
+        ImGui::TableHeadersRow();
+
+        const auto telemetries = GetJobTelemetries();
+
+        for (std::size_t i = 0; i < telemetries.size(); i++)
+        {
+            const JobTelemetry& t = *telemetries[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", JOB_NAMES[i]);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)t.Enqueued.load(std::memory_order_relaxed));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)t.Requeued.load(std::memory_order_relaxed));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)t.Executed.load(std::memory_order_relaxed));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)t.Discarded.load(std::memory_order_relaxed));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)t.Batched.load(std::memory_order_relaxed));
+            ImGui::TableNextColumn(); ImGui::Text("%.2f ms", t.QueueWait.GetPercentile(0.5) * 1e-6);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f ms", t.QueueWait.GetPercentile(0.99) * 1e-6);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f ms", t.Execution.GetPercentile(0.5) * 1e-6);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f ms", t.Execution.GetPercentile(0.99) * 1e-6);
+        }
+
+        ImGui::EndTable();
+    }
+    ImGui::Text(" ");
+
+    // Queue depth over the recorded frames
+    using QueuedCount = std::size_t JobTelemetrySample::*;
+
+    auto plot_queue_depth = [](const char* label, QueuedCount queued)
+    {
+        ImGui::Text("%s: %d", label, (int)(JobTelemetrySamples.back().*queued));
+
+        auto sample_at = [](void* data, int i) { return static_cast<float>(JobTelemetrySamples[static_cast<std::size_t>(i)].**static_cast<QueuedCount*>(data)); };
+
+        ImGui::PlotLines(label, sample_at, &queued, (int)JobTelemetrySamples.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+    };
+
+    plot_queue_depth("Queued Chunk Jobs", &JobTelemetrySample::QueuedChunkJobs);
+    plot_queue_depth("Queued Meshing Jobs", &JobTelemetrySample::QueuedMeshingJobs);
+    ImGui::Text(" ");
+
+    // Chunks per stage
+    const auto& stage_counts = JobTelemetrySamples.back().StageCounts;
+
+    for (std::size_t i = 0; i < stage_counts.size(); i++)
+    {
+        ImGui::Text("%-30s: %d", STAGE_NAMES[i], (int)stage_counts[i]);
+    }
+    ImGui::Text(" ");
+
+    static const char* dump_status = "";
+
+    if (ImGui::Button("Dump CSV"))
+    {
+        dump_status = DumpJobTelemetryCSV("JobTelemetry.csv", "JobTelemetrySamples.csv") ? "Written to JobTelemetry.csv, JobTelemetrySamples.csv" : "Failed to write CSV";
+    }
+    ImGui::SameLine();
+    ImGui::Text("%s", dump_status);
+
+    ImGui::End();
+}
+
+// Main thread cost of one replayed frame, sleeps waiting for the trace excluded.
+struct ReplayFrameTiming
+{
+    double      TraceTime = 0.0;
+    double      FrameTime = 0.0;
+    std::size_t LoadedChunks = 0;
+    std::size_t QueuedChunkJobs = 0;
+    std::size_t QueuedMeshingJobs = 0;
+};
+
+// Prints the summary of a replay and writes its per-frame timing, returns false if the file couldn't be opened.
+bool ReportReplayTiming(const char* path, const std::vector<ReplayFrameTiming>& timings)
+{
+    std::vector<double> frame_times;
+    for (const auto& timing : timings) frame_times.push_back(timing.FrameTime);
+
+    std::sort(frame_times.begin(), frame_times.end());
+
+    auto percentile = [&](double p) { return frame_times.empty() ? 0.0 : frame_times[static_cast<std::size_t>(p * static_cast<double>(frame_times.size() - 1))]; };
+
+    const auto time_to_renderable = World_GetChunkManager().GetInnerRingTimeToRenderable();
+
+    std::println("Replay: {} frames, frame time p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms, inner ring time to renderable p50 {:.1f} ms, p99 {:.1f} ms",
+        timings.size(), percentile(0.5) * 1e3, percentile(0.99) * 1e3, percentile(1.0) * 1e3, time_to_renderable.Median * 1e3, time_to_renderable.P99 * 1e3);
+
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) return false;
+
+    std::println(file, "trace_time,frame_ms,loaded_chunks,queued_chunk_jobs,queued_meshing_jobs");
+
+    for (const auto& timing : timings)
+    {
+        std::println(file, "{:.4f},{:.3f},{},{},{}", timing.TraceTime, timing.FrameTime * 1e3, timing.LoadedChunks, timing.QueuedChunkJobs, timing.QueuedMeshingJobs);
+    }
+
+    std::fclose(file);
+
+    return true;
+}
 } // namespace unnamed
 
-void Nitrocraft_Run()
+void Nitrocraft_Run(const Nitrocraft_Options& options)
 {
     // Initialization
     GLFWwindow* window = InitializeGLFWAndOpenGLContext();
@@ -227,29 +440,78 @@ void Nitrocraft_Run()
 
     Graphics_BlockOutlineRenderer_Initialize();
 
-    WorldRenderer.Initialize();
+    Scheduler = std::make_unique<TaskScheduler>(WorkerThreadCount);
+
+    WorldRenderer.Initialize(*Scheduler);
 
-    World_Initialize();
+    World_Generation_Settings generation_settings;
+
+    if (options.CaveLattice) generation_settings.CaveSampling = World_Generation_CaveSampling::Lattice;
+
+    World_Generation_Initialize(WorldSeed);
+    World_Generation_SetSettings(generation_settings);
+
+    World_Initialize(*Scheduler);
 
     //// Pipeline config
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    //// Player info
+    //// Trace
+    World_TraceRecorder trace_recorder;
+
+    if (!options.RecordTracePath.empty() && !trace_recorder.Open(options.RecordTracePath))
+    {
+        std::println("Error: Failed to open {} for recording", options.RecordTracePath);
+    }
+
+    std::vector<World_TraceFrame> replay_frames;
+
+    if (!options.ReplayTracePath.empty())
+    {
+        if (auto frames = World_Trace_Load(options.ReplayTracePath)) replay_frames = std::move(frames.value());
+        else std::println("Error: Failed to load trace {}", options.ReplayTracePath);
+    }
+
+    std::size_t                    replay_index = 0;
+    std::vector<ReplayFrameTiming> replay_timings;
+
+    Timer trace_timer;
 
     // Loop
     while (is_running)
     {
         //// Update
+        if (replay_index < replay_frames.size())
+        {
+            const World_TraceFrame& frame = replay_frames[replay_index];
+
+            // One recorded frame per frame, never ahead of the recording: workers get at least the recorded time.
+            const double ahead = frame.Time - trace_timer.Elapsed();
+            if (ahead > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(ahead));
+
+            camera.SetPose(frame.CameraPosition, frame.CameraYaw, frame.CameraPitch);
+
+            RenderDistance = frame.RenderDistance;
+            World_SetRenderDistance(RenderDistance);
+        }
+
+        Timer frame_timer;
+
         ImGUI_NewFrame();
 
         if (glfwWindowShouldClose(window)) is_running = false;
 
-        RecalculateCamera(camera, window, timer.Elapsed());
+        if (replay_frames.empty()) RecalculateCamera(camera, window, timer.Elapsed());
 
         timer.Reset();
 
+        // Render distance changes from the UI take effect from the next frame on.
+        trace_recorder.Record(World_TraceFrame{ trace_timer.Elapsed(), camera.GetPosition(), camera.GetYaw(), camera.GetPitch(), static_cast<std::uint8_t>(RenderDistance), {} });
+
         World_Update(camera);
 
+        WorldRenderer.EvictChunks(World_TakeUnloadedChunkIDs());
+
         WorldRenderer.PrepareChunksToRender(World_GetChunkManager().GetChunksInRenderArea_MainThread());
 
         auto raycast_result_opt = World_CastRay(camera.GetPosition(), camera.GetFront(), 10.0f);
@@ -279,10 +541,32 @@ void Nitrocraft_Run()
             ImGui::Text("Z Rotation : %.2f", camera.GetFront().z);
             ImGui::Text(" ");
 
-            ImGui::Text("Chunk Gen Threads: %d", World_GetChunkManager().GetWorkerThreadCount());
+            ImGui::Text("Worker Threads: %d", (int)Scheduler->GetWorkerCount());
             ImGui::Text(" ");
 
             ImGui::Text("Chunks Loaded: %d", World_GetChunkManager().GetLoadedChunkCount());
+            ImGui::Text("Chunks Unloaded: %d", (int)World_GetChunkManager().GetUnloadedChunkCount());
+            ImGui::Text("Chunk Memory: %.1f / %.1f MB", World_GetChunkManager().GetChunkMemoryUsage() / (1024.0 * 1024.0), World_GetChunkManager().GetChunkMemoryBudget() / (1024.0 * 1024.0));
+
+            auto pool_text = [](const char* name, World_Chunk_PoolOccupancy occupancy)
+            {
+                ImGui::Text("%s Pool: %d / %d (+%d heap), %.1f MB", name, (int)occupancy.Used, (int)occupancy.Capacity, (int)occupancy.Overflow, occupancy.Bytes / (1024.0 * 1024.0));
+            };
+
+            pool_text("Storage", World_Chunk_GetStoragePoolOccupancy());
+            pool_text("Block Section", World_Chunk_GetSectionBlockPoolOccupancy());
+            pool_text("Light Section", World_Chunk_GetSectionLightPoolOccupancy());
+            ImGui::Text(" ");
+
+            auto time_to_renderable = World_GetChunkManager().GetInnerRingTimeToRenderable();
+            ImGui::Text("Inner Ring Time To Renderable (%d samples):", (int)time_to_renderable.SampleCount);
+            ImGui::Text("  Median : %.1f ms", time_to_renderable.Median * 1000.0);
+            ImGui::Text("  P99    : %.1f ms", time_to_renderable.P99 * 1000.0);
+            ImGui::Text(" ");
+
+            ImGui::Text("Executed Chunk Jobs: %llu", (unsigned long long)World_GetChunkManager().GetExecutedJobCount());
+            ImGui::Text("Cancelled Chunk Jobs: %llu", (unsigned long long)World_GetChunkManager().GetCancelledJobCount());
+            ImGui::Text("Wasted Chunk Jobs: %llu", (unsigned long long)World_GetChunkManager().GetWastedJobCount());
             ImGui::Text(" ");
 
             auto id = World_FromGlobalToChunkID(camera.GetPosition());
@@ -290,7 +574,7 @@ void Nitrocraft_Run()
             ImGui::Text(" ");
 
             auto chunk = World_GetChunkAt(camera.GetPosition());
-            ImGui::Text("Current Chunk Stage : %d", chunk->Stage.load(std::memory_order_relaxed));
+            ImGui::Text("Current Chunk Stage : %s", STAGE_NAMES[(std::size_t)chunk->Stage().load(std::memory_order_relaxed)]);
             ImGui::Text(" ");
 
             ImGui::Text("Sunlight Level : %02d", (int)World_ExtractSunlight(World_GetLightAt(camera.GetPosition())));
@@ -335,6 +619,8 @@ void Nitrocraft_Run()
         }
         ImGui::End();
 
+        ImGUI_JobTelemetryWindow();
+
         //// Render
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -352,12 +638,33 @@ void Nitrocraft_Run()
         glfwSwapBuffers(window);
 
         glfwPollEvents();
+
+        if (replay_index < replay_frames.size())
+        {
+            const World_ChunkManager& manager = World_GetChunkManager();
+
+            replay_timings.push_back(ReplayFrameTiming{ replay_frames[replay_index].Time, frame_timer.Elapsed(), manager.GetLoadedChunkCount(), manager.GetQueuedJobCount(), WorldRenderer.GetQueuedMeshingJobCount() });
+
+            if (++replay_index == replay_frames.size()) is_running = false;
+        }
+    }
+
+    trace_recorder.Close();
+
+    if (!replay_timings.empty())
+    {
+        if (!ReportReplayTiming("ReplayTiming.csv", replay_timings)) std::println("Error: Failed to write ReplayTiming.csv");
+
+        if (!DumpJobTelemetryCSV("JobTelemetry.csv", "JobTelemetrySamples.csv")) std::println("Error: Failed to write the job telemetry");
     }
 
     // Terminate
+    // Meshing jobs read chunks, the renderer stops them before the world goes.
+    WorldRenderer.Terminate();
+
     World_Terminate();
 
-    WorldRenderer.Terminate();
+    Scheduler.reset();
 
     ImGUI_Terminate();
     
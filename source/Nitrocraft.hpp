@@ -1,3 +1,12 @@
 #pragma once
 
-void Nitrocraft_Run();
+#include <string>
+
+struct Nitrocraft_Options
+{
+    std::string RecordTracePath;     // Records the camera and render distance of every frame when set
+    std::string ReplayTracePath;     // Replays a recorded trace instead of taking input when set, then exits
+    bool        CaveLattice = false; // Samples cave noise on a coarse lattice instead of at every block
+};
+
+void Nitrocraft_Run(const Nitrocraft_Options& options = {});
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <array>
+#include <bit>
+#include <algorithm>
 
 enum class Array3DStoreOrder
 {
@@ -11,8 +14,43 @@ enum class Array3DStoreOrder
     YZX,
     ZXY,
     ZYX,
+    MORTON, // Z-order curve, bits interleaved y first. Sizes are rounded up to powers of two.
+    BRICK4, // 4x4x4 bricks stored YXZ, elements within a brick stored YXZ. Sizes are rounded up to multiples of 4.
 };
 
+namespace Array3D_Detail
+{
+    // Morton code contribution of every coordinate along one axis: bit b of y, x and z are given consecutive positions,
+    // axes running out of bits drop out so the codes of non-cubic arrays stay dense.
+    template<std::size_t X, std::size_t Y, std::size_t Z, int Axis, std::size_t N>
+    constexpr std::array<std::uint32_t, N> MortonSpreadTable = []
+    {
+        constexpr int bits[3] = { std::bit_width(X - 1), std::bit_width(Y - 1), std::bit_width(Z - 1) };
+        constexpr int order[3] = { 1, 0, 2 };
+
+        std::array<std::uint32_t, N> table{};
+
+        for (std::size_t v = 0; v < N; v++)
+        {
+            int position = 0;
+
+            for (int b = 0; b < std::max({ bits[0], bits[1], bits[2] }); b++)
+            {
+                for (int axis : order)
+                {
+                    if (b >= bits[axis]) continue;
+
+                    if (axis == Axis) table[v] |= static_cast<std::uint32_t>((v >> b) & 1) << position;
+
+                    position++;
+                }
+            }
+        }
+
+        return table;
+    }();
+}
+
 template<typename T, std::size_t X, std::size_t Y, std::size_t Z, Array3DStoreOrder O = Array3DStoreOrder::XYZ>
 class Array3D
 {
@@ -23,7 +61,9 @@ public:
         O == Array3DStoreOrder::YXZ ||
         O == Array3DStoreOrder::YZX ||
         O == Array3DStoreOrder::ZXY ||
-        O == Array3DStoreOrder::ZYX,
+        O == Array3DStoreOrder::ZYX ||
+        O == Array3DStoreOrder::MORTON ||
+        O == Array3DStoreOrder::BRICK4,
         "Unsupported Array3DStoreOrder"
     );
 
@@ -36,6 +76,12 @@ public:
     static constexpr size_type  Volume = X * Y * Z;
     static constexpr Array3DStoreOrder Order = O;
 
+    // Elements actually stored, Volume plus the padding of the MORTON and BRICK4 orders.
+    static constexpr size_type  StorageSize =
+        (O == Array3DStoreOrder::MORTON) ? std::bit_ceil(X) * std::bit_ceil(Y) * std::bit_ceil(Z) :
+        (O == Array3DStoreOrder::BRICK4) ? ((X + 3) & ~size_type{ 3 }) * ((Y + 3) & ~size_type{ 3 }) * ((Z + 3) & ~size_type{ 3 }) :
+        Volume;
+
     void Fill(const T& v) { m_Elements.fill(v); }
 
     constexpr       T& At(size_type x, size_type y, size_type z)       noexcept { return m_Elements[IndexOf(x, y, z)]; }
@@ -43,6 +89,7 @@ public:
     constexpr       T& operator[](size_type index)       noexcept { return m_Elements[index]; }
     constexpr const T& operator[](size_type index) const noexcept { return m_Elements[index]; }
 
+    // Storage in store order, padding included.
     constexpr       T* Data()       noexcept { return m_Elements.data(); }
     constexpr const T* Data() const noexcept { return m_Elements.data(); }
 
@@ -53,19 +100,34 @@ public:
     constexpr auto cbegin() const noexcept { return m_Elements.cbegin(); }
     constexpr auto cend()   const noexcept { return m_Elements.cend(); }
 
-private:
-    std::array<T, Volume> m_Elements;
-
     static constexpr size_type IndexOf(size_type x, size_type y, size_type z) noexcept
     {
 #ifndef NDEBUG
         assert(x < X && y < Y && z < Z);
 #endif
-        if constexpr (O == Array3DStoreOrder::XYZ) { return x + (y * X) + (z * (X * Y)); }
-        else if      (O == Array3DStoreOrder::XZY) { return x + (z * X) + (y * (X * Z)); }
-        else if      (O == Array3DStoreOrder::YXZ) { return y + (x * Y) + (z * (Y * X)); }
-        else if      (O == Array3DStoreOrder::YZX) { return y + (z * Y) + (x * (Y * Z)); }
-        else if      (O == Array3DStoreOrder::ZXY) { return z + (x * Z) + (y * (Z * X)); }
-        else                                       { return z + (y * Z) + (x * (Z * Y)); }
+        if constexpr      (O == Array3DStoreOrder::XYZ) { return x + (y * X) + (z * (X * Y)); }
+        else if constexpr (O == Array3DStoreOrder::XZY) { return x + (z * X) + (y * (X * Z)); }
+        else if constexpr (O == Array3DStoreOrder::YXZ) { return y + (x * Y) + (z * (Y * X)); }
+        else if constexpr (O == Array3DStoreOrder::YZX) { return y + (z * Y) + (x * (Y * Z)); }
+        else if constexpr (O == Array3DStoreOrder::ZXY) { return z + (x * Z) + (y * (Z * X)); }
+        else if constexpr (O == Array3DStoreOrder::ZYX) { return z + (y * Z) + (x * (Z * Y)); }
+        else if constexpr (O == Array3DStoreOrder::MORTON)
+        {
+            return Array3D_Detail::MortonSpreadTable<X, Y, Z, 0, X>[x] |
+                   Array3D_Detail::MortonSpreadTable<X, Y, Z, 1, Y>[y] |
+                   Array3D_Detail::MortonSpreadTable<X, Y, Z, 2, Z>[z];
+        }
+        else
+        {
+            constexpr size_type BX = (X + 3) / 4;
+            constexpr size_type BY = (Y + 3) / 4;
+
+            const size_type brick = (y >> 2) + ((x >> 2) * BY) + ((z >> 2) * (BY * BX));
+
+            return (brick << 6) | (y & 3) | ((x & 3) << 2) | ((z & 3) << 4);
+        }
     }
+
+private:
+    std::array<T, StorageSize> m_Elements;
 };
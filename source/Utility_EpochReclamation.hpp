@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <print>
+
+// Epoch based reclamation.
+// Reader threads register once, wrap their accesses in Enter/Leave and unregister when they exit, freeing their slot.
+// The reclaiming thread unlinks objects first, then calls Retire and frees them once IsSafe(epoch) holds:
+// every reader that could still have seen them has left its critical section by then.
+class EpochReclamation
+{
+public:
+    static constexpr std::size_t MAX_THREADS = 64;
+
+    EpochReclamation()
+    {
+        for (auto& slot : m_Slots) slot.Epoch.store(IDLE, std::memory_order_relaxed);
+    }
+
+    EpochReclamation(const EpochReclamation&) = delete;
+    EpochReclamation& operator=(const EpochReclamation&) = delete;
+
+    // Called once per reader thread. At most MAX_THREADS readers can be registered at a time, aborts beyond.
+    std::size_t RegisterThread()
+    {
+        for (std::size_t slot = 0; slot < MAX_THREADS; slot++)
+        {
+            bool in_use = false;
+
+            if (m_Slots[slot].InUse.load(std::memory_order_relaxed) || !m_Slots[slot].InUse.compare_exchange_strong(in_use, true, std::memory_order_acquire)) continue;
+
+            // Slots scanned by IsSafe, raised before the first Enter so a reclaimer retiring after it scans this slot.
+            std::size_t count = m_SlotCount.load(std::memory_order_seq_cst);
+            while (count <= slot && !m_SlotCount.compare_exchange_weak(count, slot + 1, std::memory_order_seq_cst));
+
+            return slot;
+        }
+
+        std::println(stderr, "Error: EpochReclamation: more than {} reader threads registered", MAX_THREADS);
+        std::abort();
+    }
+
+    // Called by a reader thread before it exits, outside Enter/Leave.
+    void UnregisterThread(std::size_t slot)
+    {
+        m_Slots[slot].Epoch.store(IDLE, std::memory_order_release);
+        m_Slots[slot].InUse.store(false, std::memory_order_release);
+    }
+
+    void Enter(std::size_t slot)
+    {
+        m_Slots[slot].Epoch.store(m_Epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+
+    void Leave(std::size_t slot)
+    {
+        m_Slots[slot].Epoch.store(IDLE, std::memory_order_release);
+    }
+
+    // Called from the reclaiming thread after unlinking. Returns the epoch to pass to IsSafe.
+    std::uint64_t Retire()
+    {
+        return m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    bool IsSafe(std::uint64_t retire_epoch) const
+    {
+        const std::size_t count = m_SlotCount.load(std::memory_order_seq_cst);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (m_Slots[i].Epoch.load(std::memory_order_seq_cst) <= retire_epoch) return false;
+        }
+
+        return true;
+    }
+
+private:
+    static constexpr std::uint64_t IDLE = static_cast<std::uint64_t>(-1);
+
+    struct alignas(64) Slot
+    {
+        std::atomic<std::uint64_t> Epoch;
+        std::atomic<bool>          InUse = false;
+    };
+
+    std::atomic<std::uint64_t>     m_Epoch = 1;
+    std::atomic<std::size_t>       m_SlotCount = 0; // Highest slot ever registered + 1
+    std::array<Slot, MAX_THREADS>  m_Slots;
+};
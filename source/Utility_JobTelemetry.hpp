@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+
+// Log-linear histogram of durations in nanoseconds, HDR style.
+// Each power of two is split into SUB_BUCKET_COUNT linear buckets, values below SUB_BUCKET_COUNT get one bucket each:
+// percentiles are within 1 / SUB_BUCKET_COUNT of the recorded values over the whole 64-bit range.
+// Recorded lock-free from any thread. Reads while recording are approximate but never torn per bucket.
+class LatencyHistogram
+{
+public:
+    static constexpr std::size_t SUB_BUCKET_BITS  = 4;
+    static constexpr std::size_t SUB_BUCKET_COUNT = std::size_t{ 1 } << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKET_COUNT     = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    void Record(std::uint64_t nanoseconds)
+    {
+        m_Buckets[BucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+
+        m_Count.fetch_add(1, std::memory_order_relaxed);
+        m_Sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+        std::uint64_t max = m_Max.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !m_Max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {}
+    }
+
+    void RecordSeconds(double seconds)
+    {
+        Record(static_cast<std::uint64_t>(std::max(seconds, 0.0) * 1e9));
+    }
+
+    std::uint64_t GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+    std::uint64_t GetMax()   const { return m_Max.load(std::memory_order_relaxed); }
+
+    double GetMean() const
+    {
+        const std::uint64_t count = GetCount();
+
+        return count != 0 ? static_cast<double>(m_Sum.load(std::memory_order_relaxed)) / static_cast<double>(count) : 0.0;
+    }
+
+    // Midpoint of the bucket holding the p-th value (0 <= p <= 1), 0 when empty.
+    double GetPercentile(double p) const
+    {
+        std::array<std::uint64_t, BUCKET_COUNT> counts;
+        std::uint64_t total = 0;
+
+        for (std::size_t i = 0; i < BUCKET_COUNT; i++) total += counts[i] = m_Buckets[i].load(std::memory_order_relaxed);
+
+        if (total == 0) return 0.0;
+
+        const std::uint64_t rank = std::min(total - 1, static_cast<std::uint64_t>(p * static_cast<double>(total)));
+
+        std::uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += counts[i];
+
+            if (seen > rank) return 0.5 * (static_cast<double>(LowerBoundOf(i)) + static_cast<double>(LowerBoundOf(i + 1) - 1));
+        }
+
+        return static_cast<double>(GetMax());
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> m_Buckets{};
+    std::atomic<std::uint64_t>                           m_Count = 0;
+    std::atomic<std::uint64_t>                           m_Sum   = 0;
+    std::atomic<std::uint64_t>                           m_Max   = 0;
+
+    static std::size_t BucketOf(std::uint64_t value)
+    {
+        if (value < SUB_BUCKET_COUNT) return static_cast<std::size_t>(value);
+
+        // Magnitude of the leading bit, then the SUB_BUCKET_BITS bits after it.
+        const std::size_t exponent = static_cast<std::size_t>(std::bit_width(value)) - 1;
+        const std::size_t sub      = static_cast<std::size_t>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub;
+    }
+
+    static std::uint64_t LowerBoundOf(std::size_t bucket)
+    {
+        if (bucket < SUB_BUCKET_COUNT) return bucket;
+        if (bucket >= BUCKET_COUNT) return UINT64_MAX;
+
+        const std::size_t magnitude = bucket / SUB_BUCKET_COUNT;
+        const std::size_t sub       = bucket % SUB_BUCKET_COUNT;
+
+        return static_cast<std::uint64_t>(SUB_BUCKET_COUNT + sub) << (magnitude - 1);
+    }
+};
+
+// Telemetry of one job type, recorded by whoever enqueues and runs the jobs.
+struct JobTelemetry
+{
+    LatencyHistogram QueueWait; // Enqueued to popped by a worker
+    LatencyHistogram Execution; // Popped to done, for the jobs that ran
+
+    std::atomic<std::uint64_t> Enqueued  = 0;
+    std::atomic<std::uint64_t> Requeued  = 0; // Enqueued again after being discarded, included in Enqueued
+    std::atomic<std::uint64_t> Executed  = 0;
+    std::atomic<std::uint64_t> Discarded = 0; // Dropped without doing their work: cancelled, stale or already taken
+    std::atomic<std::uint64_t> Batched   = 0; // Work done for other chunks by executed jobs, batching them with their own
+};
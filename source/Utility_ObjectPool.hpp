@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <utility>
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+// Fixed capacity pool of T backed by a single reserved arena.
+// Allocate and Release are O(1) and lock-free: released slots go to an index based free list, tagged against ABA.
+// Untouched slots are handed out in order, so arena pages are only committed once used: mapped lazily on POSIX,
+// committed in COMMIT_GRANULARITY steps on Windows.
+// Objects are constructed on Allocate and destroyed on Release, a recycled object comes back as freshly constructed.
+// When the arena is exhausted, objects are allocated from the heap instead and counted as overflow until released.
+// The pool must outlive every object allocated from it.
+template<typename T>
+class ObjectPool
+{
+public:
+    explicit ObjectPool(std::size_t capacity)
+        : m_Capacity{ static_cast<std::uint32_t>(capacity) }
+    {
+        m_Arena = static_cast<Slot*>(ReserveArena(sizeof(Slot) * m_Capacity));
+
+        // Without an arena every object comes from the heap.
+        if (m_Arena == nullptr)
+        {
+            m_Capacity = 0;
+            return;
+        }
+
+        m_Next = new std::atomic<std::uint32_t>[m_Capacity];
+    }
+
+    ~ObjectPool()
+    {
+        ReleaseArena(m_Arena, sizeof(Slot) * m_Capacity);
+        delete[] m_Next;
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template<typename... Args>
+    T* Allocate(Args&&... args)
+    {
+        std::uint32_t index = Pop();
+
+        if (index == NONE)
+        {
+            index = m_Untouched.fetch_add(1, std::memory_order_relaxed);
+
+            if (index >= m_Capacity)
+            {
+                m_Untouched.store(m_Capacity, std::memory_order_relaxed);
+                m_OverflowCount.fetch_add(1, std::memory_order_relaxed);
+
+                return new T(std::forward<Args>(args)...);
+            }
+
+            // Out of commit charge, the slot is left unused.
+            if (!CommitSlot(index))
+            {
+                m_OverflowCount.fetch_add(1, std::memory_order_relaxed);
+
+                return new T(std::forward<Args>(args)...);
+            }
+        }
+
+        m_UsedCount.fetch_add(1, std::memory_order_relaxed);
+
+        return ::new (static_cast<void*>(&m_Arena[index])) T(std::forward<Args>(args)...);
+    }
+
+    void Release(T* object)
+    {
+        if (object == nullptr) return;
+
+        const auto* slot = reinterpret_cast<const Slot*>(object);
+
+        if (slot < m_Arena || slot >= m_Arena + m_Capacity)
+        {
+            m_OverflowCount.fetch_sub(1, std::memory_order_relaxed);
+
+            delete object;
+            return;
+        }
+
+        object->~T();
+
+        m_UsedCount.fetch_sub(1, std::memory_order_relaxed);
+
+        Push(static_cast<std::uint32_t>(slot - m_Arena));
+    }
+
+    // Occupancy
+    std::size_t GetCapacity()      const { return m_Capacity; }
+    std::size_t GetUsedCount()     const { return m_UsedCount.load(std::memory_order_relaxed); }
+    std::size_t GetOverflowCount() const { return m_OverflowCount.load(std::memory_order_relaxed); }
+
+    // Arena bytes touched so far, including free slots.
+    std::size_t GetCommittedBytes() const
+    {
+        const std::uint32_t touched = m_Untouched.load(std::memory_order_relaxed);
+
+        return sizeof(Slot) * (touched < m_Capacity ? touched : m_Capacity);
+    }
+
+private:
+    struct alignas(T) Slot
+    {
+        std::byte Bytes[sizeof(T)];
+    };
+
+    static constexpr std::uint32_t NONE = static_cast<std::uint32_t>(-1);
+
+    static constexpr std::size_t COMMIT_GRANULARITY = 64 * 1024;
+
+    Slot*                       m_Arena = nullptr;
+    std::atomic<std::uint32_t>* m_Next  = nullptr; // Free list links, kept outside the slots so popping never reads a reused object.
+    std::uint32_t               m_Capacity;
+
+    std::atomic<std::uint64_t> m_FreeHead  = NONE; // Tag in the high 32 bits, slot index in the low 32 bits.
+    std::atomic<std::uint32_t> m_Untouched = 0;
+    std::atomic<std::size_t>   m_CommittedBytes = 0; // Windows only, arena prefix committed so far.
+
+    std::atomic<std::size_t> m_UsedCount     = 0;
+    std::atomic<std::size_t> m_OverflowCount = 0;
+
+    std::uint32_t Pop()
+    {
+        std::uint64_t head = m_FreeHead.load(std::memory_order_acquire);
+
+        while (static_cast<std::uint32_t>(head) != NONE)
+        {
+            const std::uint32_t index = static_cast<std::uint32_t>(head);
+            const std::uint64_t next  = ((head >> 32) + 1) << 32 | m_Next[index].load(std::memory_order_relaxed);
+
+            if (m_FreeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire)) return index;
+        }
+
+        return NONE;
+    }
+
+    void Push(std::uint32_t index)
+    {
+        std::uint64_t head = m_FreeHead.load(std::memory_order_relaxed);
+        std::uint64_t next;
+
+        do
+        {
+            m_Next[index].store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+
+            next = ((head >> 32) + 1) << 32 | index;
+        }
+        while (!m_FreeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Commits the arena up to the end of a slot handed out for the first time.
+    bool CommitSlot(std::uint32_t index)
+    {
+#if defined(_WIN32)
+        const std::size_t slot_end  = sizeof(Slot) * (static_cast<std::size_t>(index) + 1);
+        std::size_t       committed = m_CommittedBytes.load(std::memory_order_acquire);
+
+        if (slot_end <= committed) return true;
+
+        const std::size_t arena_bytes = sizeof(Slot) * m_Capacity;
+        const std::size_t commit_end  = std::min((slot_end + COMMIT_GRANULARITY - 1) / COMMIT_GRANULARITY * COMMIT_GRANULARITY, arena_bytes);
+
+        // Threads committing overlapping ranges concurrently is harmless, committing is idempotent.
+        if (VirtualAlloc(reinterpret_cast<std::byte*>(m_Arena) + committed, commit_end - committed, MEM_COMMIT, PAGE_READWRITE) == nullptr) return false;
+
+        while (committed < commit_end && !m_CommittedBytes.compare_exchange_weak(committed, commit_end, std::memory_order_release, std::memory_order_acquire));
+
+        return true;
+#else
+        (void)index;
+        return true;
+#endif
+    }
+
+    static void* ReserveArena(std::size_t bytes)
+    {
+        if (bytes == 0) return nullptr;
+
+#if defined(_WIN32)
+        return VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+        void* arena = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if (arena == MAP_FAILED) return nullptr;
+
+    #if defined(MADV_HUGEPAGE)
+        // Transparent huge pages, where available, cut TLB misses over the arena.
+        madvise(arena, bytes, MADV_HUGEPAGE);
+    #endif
+
+        return arena;
+#endif
+    }
+
+    static void ReleaseArena(void* arena, std::size_t bytes)
+    {
+        if (arena == nullptr) return;
+
+#if defined(_WIN32)
+        (void)bytes;
+        VirtualFree(arena, 0, MEM_RELEASE);
+#else
+        munmap(arena, bytes);
+#endif
+    }
+};
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include "Utility_Array3D.hpp"
+
+// Palette compressed array of N one-byte elements.
+// Elements are stored as bit packed indices into a palette of the distinct values, 0/1/2/4/8 bits per element.
+// 0 bits means every element holds the single palette value and no index storage is allocated.
+// Set grows the index width on demand, Encode rebuilds the array from scratch with the smallest width.
+// Not thread safe: a writer must not run concurrently with readers.
+template<typename T, std::size_t N>
+class PaletteArray
+{
+public:
+    static_assert(sizeof(T) == 1 && std::is_trivially_copyable_v<T>, "PaletteArray element must be a trivially copyable byte");
+    static_assert(N % 64 == 0, "PaletteArray size must be a multiple of 64");
+
+    using value_type = T;
+    using size_type  = std::size_t;
+
+    static constexpr size_type Volume = N;
+
+    PaletteArray() : m_Palette{ T{} } {}
+
+    PaletteArray(const PaletteArray&) = delete;
+    PaletteArray& operator=(const PaletteArray&) = delete;
+
+    T Get(size_type index) const noexcept
+    {
+        if (m_Bits == 0) return m_Palette[0];
+
+        const std::uint64_t word   = m_Words[index >> m_WordShift];
+        const unsigned      offset = static_cast<unsigned>(index & ((size_type{ 1 } << m_WordShift) - 1)) * m_Bits;
+
+        return m_Palette[(word >> offset) & ((std::uint64_t{ 1 } << m_Bits) - 1)];
+    }
+
+    void Set(size_type index, T value)
+    {
+        std::size_t palette_index = FindOrAppend(value);
+
+        if (m_Palette.size() > (std::size_t{ 1 } << m_Bits)) Resize(BitsFor(m_Palette.size()));
+
+        if (m_Bits == 0) return;
+
+        std::uint64_t& word   = m_Words[index >> m_WordShift];
+        const unsigned offset = static_cast<unsigned>(index & ((size_type{ 1 } << m_WordShift) - 1)) * m_Bits;
+        const std::uint64_t mask = ((std::uint64_t{ 1 } << m_Bits) - 1) << offset;
+
+        word = (word & ~mask) | (static_cast<std::uint64_t>(palette_index) << offset);
+    }
+
+    void Fill(T value)
+    {
+        m_Palette.assign(1, value);
+        m_Words.reset();
+        m_Bits = 0;
+        m_WordShift = 0;
+    }
+
+    // Bulk decode into N elements.
+    void Decode(T* out) const noexcept
+    {
+        switch (m_Bits)
+        {
+        case 0:  std::fill(out, out + N, m_Palette[0]); break;
+        case 1:  DecodeWords<1>(out); break;
+        case 2:  DecodeWords<2>(out); break;
+        case 4:  DecodeWords<4>(out); break;
+        default: DecodeWords<8>(out); break;
+        }
+    }
+
+    // Bulk encode from N elements.
+    void Encode(const T* values)
+    {
+        std::array<std::int16_t, 256> lookup;
+        lookup.fill(-1);
+
+        m_Palette.clear();
+
+        for (size_type i = 0; i < N; i++)
+        {
+            auto& slot = lookup[std::bit_cast<std::uint8_t>(values[i])];
+
+            if (slot < 0)
+            {
+                slot = static_cast<std::int16_t>(m_Palette.size());
+                m_Palette.push_back(values[i]);
+            }
+        }
+
+        m_Palette.shrink_to_fit();
+
+        SetBits(BitsFor(m_Palette.size()));
+
+        if (m_Bits == 0) return;
+
+        for (size_type i = 0; i < N; i++)
+        {
+            const std::uint64_t palette_index = static_cast<std::uint64_t>(lookup[std::bit_cast<std::uint8_t>(values[i])]);
+
+            m_Words[i >> m_WordShift] |= palette_index << (static_cast<unsigned>(i & ((size_type{ 1 } << m_WordShift) - 1)) * m_Bits);
+        }
+    }
+
+    unsigned    GetBitsPerElement() const noexcept { return m_Bits; }
+    std::size_t GetPaletteSize()    const noexcept { return m_Palette.size(); }
+
+    // Heap bytes owned by this array, excluding sizeof(*this).
+    std::size_t GetHeapUsage() const noexcept
+    {
+        return m_Palette.capacity() * sizeof(T) + (m_Bits == 0 ? 0u : N * m_Bits / 8);
+    }
+
+private:
+    std::vector<T>                   m_Palette;
+    std::unique_ptr<std::uint64_t[]> m_Words;
+    unsigned                         m_Bits = 0;
+    unsigned                         m_WordShift = 0; // log2 of elements per word
+
+    static unsigned BitsFor(std::size_t palette_size) noexcept
+    {
+        if (palette_size <= 1)  return 0;
+        if (palette_size <= 2)  return 1;
+        if (palette_size <= 4)  return 2;
+        if (palette_size <= 16) return 4;
+        return 8;
+    }
+
+    std::size_t FindOrAppend(T value)
+    {
+        for (std::size_t i = 0; i < m_Palette.size(); i++)
+        {
+            if (std::bit_cast<std::uint8_t>(m_Palette[i]) == std::bit_cast<std::uint8_t>(value)) return i;
+        }
+
+        m_Palette.push_back(value);
+
+        return m_Palette.size() - 1;
+    }
+
+    void SetBits(unsigned bits)
+    {
+        m_Bits = bits;
+        m_WordShift = (bits == 0) ? 0u : 6u - static_cast<unsigned>(std::countr_zero(bits));
+        m_Words = (bits == 0) ? nullptr : std::make_unique<std::uint64_t[]>(N * bits / 64);
+    }
+
+    void Resize(unsigned bits)
+    {
+        // Repack the existing indices with the new width. Palette order is kept.
+        auto indices = std::make_unique<std::uint8_t[]>(N);
+
+        for (size_type i = 0; i < N; i++)
+        {
+            indices[i] = (m_Bits == 0) ? 0u : static_cast<std::uint8_t>((m_Words[i >> m_WordShift] >> (static_cast<unsigned>(i & ((size_type{ 1 } << m_WordShift) - 1)) * m_Bits)) & ((1u << m_Bits) - 1));
+        }
+
+        SetBits(bits);
+
+        for (size_type i = 0; i < N; i++)
+        {
+            m_Words[i >> m_WordShift] |= static_cast<std::uint64_t>(indices[i]) << (static_cast<unsigned>(i & ((size_type{ 1 } << m_WordShift) - 1)) * m_Bits);
+        }
+    }
+
+    template<unsigned B>
+    void DecodeWords(T* out) const noexcept
+    {
+        constexpr size_type      PER_WORD = 64 / B;
+        constexpr std::uint64_t  MASK     = (std::uint64_t{ 1 } << B) - 1;
+
+        for (size_type w = 0; w < N / PER_WORD; w++)
+        {
+            std::uint64_t word = m_Words[w];
+
+            for (size_type j = 0; j < PER_WORD; j++, word >>= B)
+            {
+                out[w * PER_WORD + j] = m_Palette[word & MASK];
+            }
+        }
+    }
+};
+
+// PaletteArray addressed like Array3D with the same store order, so both can be converted with Decode/Encode.
+template<typename T, std::size_t X, std::size_t Y, std::size_t Z, Array3DStoreOrder O = Array3DStoreOrder::XYZ>
+class PaletteArray3D
+{
+public:
+    using value_type = T;
+    using size_type  = std::size_t;
+    using FlatArray  = Array3D<T, X, Y, Z, O>;
+
+    static constexpr size_type XSize = X;
+    static constexpr size_type YSize = Y;
+    static constexpr size_type ZSize = Z;
+    static constexpr size_type Volume = X * Y * Z;
+    static constexpr Array3DStoreOrder Order = O;
+
+    static_assert(FlatArray::StorageSize == Volume, "PaletteArray3D requires a store order without padding for its sizes");
+
+    T    At(size_type x, size_type y, size_type z) const noexcept { return m_Elements.Get(FlatArray::IndexOf(x, y, z)); }
+    void Set(size_type x, size_type y, size_type z, T value)     { m_Elements.Set(FlatArray::IndexOf(x, y, z), value); }
+
+    void Fill(T value)                   { m_Elements.Fill(value); }
+    void Decode(FlatArray& out) const    { m_Elements.Decode(out.Data()); }
+    void Encode(const FlatArray& values) { m_Elements.Encode(values.Data()); }
+
+    unsigned    GetBitsPerElement() const noexcept { return m_Elements.GetBitsPerElement(); }
+    std::size_t GetPaletteSize()    const noexcept { return m_Elements.GetPaletteSize(); }
+    std::size_t GetHeapUsage()      const noexcept { return m_Elements.GetHeapUsage(); }
+
+private:
+    PaletteArray<T, Volume> m_Elements;
+};
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// Kinds of work sharing the scheduler's workers, one queue each.
+enum class TaskType : std::uint8_t
+{
+    Chunk,   // Chunk generation and lighting
+    Meshing, // Chunk meshing
+
+    COUNT,
+};
+
+// Queue of tasks of one type, owned by the system producing them.
+class TaskQueue
+{
+public:
+    virtual ~TaskQueue() = default;
+
+    // Runs one task on the calling worker. Returns false if there was none.
+    virtual bool RunTask(std::size_t worker_index) = 0;
+
+    // Whether RunTask would find a task. Producers publish tasks before calling TaskScheduler::Notify,
+    // sleeping workers re-check this after announcing themselves.
+    virtual bool HasTasks() const = 0;
+};
+
+// Worker threads shared by every task queue.
+// Idle workers take the next task from the queue with pending tasks that started the fewest tasks relative to its
+// share (stride scheduling), so queues split the workers by share while busy and any queue gets them all while the
+// others are starved. A queue coming back from idle resumes at the others' pace instead of catching up.
+class TaskScheduler
+{
+public:
+    // Main thread and chunk readers also register with the chunk epoch reclamation, which holds 64 threads.
+    static constexpr std::size_t MAX_DEFAULT_WORKER_COUNT = 32;
+
+    // One worker per hardware thread, the main thread excepted.
+    static std::size_t GetDefaultWorkerCount()
+    {
+        return std::clamp<std::size_t>(std::thread::hardware_concurrency(), 2u, MAX_DEFAULT_WORKER_COUNT + 1) - 1;
+    }
+
+    // 0 workers sizes the scheduler to the machine.
+    explicit TaskScheduler(std::size_t worker_count = 0)
+        : m_WorkerCount{ worker_count != 0 ? worker_count : GetDefaultWorkerCount() }
+        , m_WorkerUsages{ std::make_unique<WorkerUsageCounters[]>(m_WorkerCount) }
+    {
+        for (auto& slot : m_Slots) slot.Stride.store(PASS_SCALE, std::memory_order_relaxed);
+
+        m_Workers.reserve(m_WorkerCount);
+
+        for (std::size_t i = 0u; i < m_WorkerCount; ++i)
+        {
+            m_Workers.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~TaskScheduler()
+    {
+        for ([[maybe_unused]] const auto& slot : m_Slots) assert(slot.Queue.load(std::memory_order_relaxed) == nullptr);
+
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+
+            m_Stop = true;
+        }
+
+        m_Cond.notify_all();
+
+        m_Workers.clear();
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    std::size_t GetWorkerCount() const { return m_WorkerCount; }
+
+    // Time a worker spent running tasks and the tasks it ran, since the scheduler started.
+    struct WorkerUsage
+    {
+        double        BusySeconds = 0.0;
+        std::uint64_t TaskCount   = 0;
+    };
+
+    WorkerUsage GetWorkerUsage(std::size_t worker_index) const
+    {
+        const auto& counters = m_WorkerUsages[worker_index];
+
+        return WorkerUsage{ static_cast<double>(counters.BusyNanoseconds.load(std::memory_order_relaxed)) * 1e-9, counters.TaskCount.load(std::memory_order_relaxed) };
+    }
+
+    // Queues started at the pace of the registered ones.
+    void Register(TaskType type, TaskQueue& queue)
+    {
+        Slot& slot = m_Slots[static_cast<std::size_t>(type)];
+
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+
+            assert(slot.Queue.load(std::memory_order_relaxed) == nullptr);
+
+            slot.Pass.store(m_Pass.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            slot.Queue.store(&queue, std::memory_order_seq_cst);
+        }
+
+        NotifyAll();
+    }
+
+    // Returns once no worker is inside the queue anymore. Its pending tasks are left to the owner.
+    void Unregister(TaskType type)
+    {
+        Slot& slot = m_Slots[static_cast<std::size_t>(type)];
+
+        {
+            // Sleeping workers check queues under the mutex.
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+
+            slot.Queue.store(nullptr, std::memory_order_seq_cst);
+        }
+
+        while (slot.Users.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+    }
+
+    // Relative share of the workers for a queue while queues compete. 1 by default.
+    void SetShare(TaskType type, std::uint32_t share)
+    {
+        m_Slots[static_cast<std::size_t>(type)].Stride.store(PASS_SCALE / std::max(share, 1u), std::memory_order_relaxed);
+    }
+
+    // Called by producers after publishing tasks.
+    void Notify()
+    {
+        // Pairs with the sleeper count increment in WorkerLoop: either the sleeper sees the published task, or this sees the sleeper.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (m_SleepingCount.load(std::memory_order_seq_cst) == 0) return;
+
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+        }
+
+        m_Cond.notify_one();
+    }
+
+    void NotifyAll()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+        }
+
+        m_Cond.notify_all();
+    }
+
+private:
+    static constexpr std::uint64_t PASS_SCALE = 1u << 16;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<TaskQueue*>    Queue = nullptr;
+        std::atomic<std::uint32_t> Users = 0; // Workers inside Queue, Unregister waits for them.
+        std::atomic<std::uint64_t> Pass  = 0; // Advanced by Stride per task started.
+        std::atomic<std::uint64_t> Stride = 0;
+    };
+
+    std::array<Slot, static_cast<std::size_t>(TaskType::COUNT)> m_Slots;
+
+    std::atomic<std::uint64_t> m_Pass = 0; // Pass of the last task started, for queues coming back from idle.
+
+    // Written by their worker only, each on its own cache line.
+    struct alignas(64) WorkerUsageCounters
+    {
+        std::atomic<std::uint64_t> BusyNanoseconds = 0;
+        std::atomic<std::uint64_t> TaskCount       = 0;
+    };
+
+    std::size_t                            m_WorkerCount = 0;
+    std::unique_ptr<WorkerUsageCounters[]> m_WorkerUsages;
+    std::vector<std::jthread>              m_Workers;
+
+    bool                     m_Stop = false;
+    std::mutex               m_Mutex;
+    std::condition_variable  m_Cond;
+    std::atomic<std::size_t> m_SleepingCount = 0;
+
+    // Called with m_Mutex held, which keeps registered queues alive.
+    bool HasTasks_ThreadUnsafe() const
+    {
+        for (const auto& slot : m_Slots)
+        {
+            if (const TaskQueue* queue = slot.Queue.load(std::memory_order_seq_cst); queue != nullptr && queue->HasTasks()) return true;
+        }
+
+        return false;
+    }
+
+    bool RunNextTask(std::size_t worker_index)
+    {
+        // Sorted on a snapshot, other workers advance the passes meanwhile and std::sort needs a consistent order.
+        std::array<std::uint64_t, static_cast<std::size_t>(TaskType::COUNT)> passes;
+        for (std::size_t i = 0; i < passes.size(); i++) passes[i] = m_Slots[i].Pass.load(std::memory_order_relaxed);
+
+        std::array<std::size_t, static_cast<std::size_t>(TaskType::COUNT)> order;
+        std::iota(order.begin(), order.end(), std::size_t{ 0 });
+
+        std::sort(order.begin(), order.end(), [&passes](std::size_t a, std::size_t b) { return passes[a] < passes[b]; });
+
+        for (std::size_t i = 0; i < order.size(); i++)
+        {
+            Slot& slot = m_Slots[order[i]];
+
+            // Announce entering before loading the queue, pairs with Unregister.
+            slot.Users.fetch_add(1, std::memory_order_seq_cst);
+
+            bool ran = false;
+
+            if (TaskQueue* queue = slot.Queue.load(std::memory_order_seq_cst); queue != nullptr && queue->HasTasks())
+            {
+                const std::uint64_t pass = slot.Pass.fetch_add(slot.Stride.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+                // Queues skipped for lack of tasks don't bank the turns they missed.
+                for (std::size_t j = 0; j < i; j++)
+                {
+                    auto& skipped = m_Slots[order[j]].Pass;
+
+                    std::uint64_t skipped_pass = skipped.load(std::memory_order_relaxed);
+                    while (skipped_pass < pass && !skipped.compare_exchange_weak(skipped_pass, pass, std::memory_order_relaxed)) {}
+                }
+
+                m_Pass.store(pass, std::memory_order_relaxed);
+
+                const auto start = std::chrono::steady_clock::now();
+
+                ran = queue->RunTask(worker_index);
+
+                if (ran)
+                {
+                    auto& usage = m_WorkerUsages[worker_index];
+
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+                    usage.BusyNanoseconds.store(usage.BusyNanoseconds.load(std::memory_order_relaxed) + static_cast<std::uint64_t>(elapsed), std::memory_order_relaxed);
+                    usage.TaskCount.store(usage.TaskCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+            }
+
+            slot.Users.fetch_sub(1, std::memory_order_release);
+
+            if (ran) return true;
+        }
+
+        return false;
+    }
+
+    void WorkerLoop(std::size_t worker_index)
+    {
+        while (true)
+        {
+            if (RunNextTask(worker_index)) continue;
+
+            std::unique_lock lock{ m_Mutex };
+
+            // Announce sleeping before re-checking, producers check the sleeper count after publishing a task.
+            m_SleepingCount.fetch_add(1, std::memory_order_seq_cst);
+
+            m_Cond.wait(lock, [this]() { return m_Stop || HasTasks_ThreadUnsafe(); });
+
+            m_SleepingCount.fetch_sub(1, std::memory_order_relaxed);
+
+            if (m_Stop) return;
+        }
+    }
+};
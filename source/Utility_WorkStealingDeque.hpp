@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <optional>
+#include <type_traits>
+
+// Chase-Lev work stealing deque.
+// Owner thread pushes and pops at the bottom (LIFO), any other thread steals from the top (FIFO).
+// Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli, 2013).
+// Buffers outgrown by Push are retired but kept alive until the deque is destroyed, as thieves may still be reading them.
+template<typename T>
+class WorkStealingDeque
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free, "WorkStealingDeque element must be a lock-free atomic type");
+
+    explicit WorkStealingDeque(std::size_t initial_capacity = 1024)
+    {
+        std::size_t capacity = 1;
+        while (capacity < initial_capacity) capacity <<= 1;
+
+        m_Buffers.push_back(std::make_unique<Buffer>(capacity));
+        m_Buffer.store(m_Buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Called from owner thread.
+    void Push(T value)
+    {
+        const std::int64_t b = m_Bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_Top.load(std::memory_order_acquire);
+
+        Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+
+        if (b - t > static_cast<std::int64_t>(buffer->Capacity) - 1)
+        {
+            buffer = Grow(buffer, b, t);
+        }
+
+        buffer->Put(b, value);
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        m_Bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Called from owner thread.
+    std::optional<T> Pop()
+    {
+        const std::int64_t b = m_Bottom.load(std::memory_order_relaxed) - 1;
+
+        Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+
+        m_Bottom.store(b, std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::int64_t t = m_Top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // Empty
+            m_Bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T value = buffer->Get(b);
+
+        if (t == b)
+        {
+            // Last element, race against thieves.
+            const bool won = m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+            m_Bottom.store(b + 1, std::memory_order_relaxed);
+
+            if (!won) return std::nullopt;
+        }
+
+        return value;
+    }
+
+    // Called from any thread. Returns std::nullopt when empty or when losing a race to another thread.
+    std::optional<T> Steal()
+    {
+        std::int64_t t = m_Top.load(std::memory_order_acquire);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const std::int64_t b = m_Bottom.load(std::memory_order_acquire);
+
+        if (t >= b) return std::nullopt;
+
+        Buffer* buffer = m_Buffer.load(std::memory_order_acquire);
+
+        T value = buffer->Get(t);
+
+        if (!m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return std::nullopt;
+
+        return value;
+    }
+
+    // Approximation when called concurrently with Push/Pop/Steal.
+    bool Empty() const
+    {
+        return m_Bottom.load(std::memory_order_seq_cst) <= m_Top.load(std::memory_order_seq_cst);
+    }
+
+    std::size_t Size() const
+    {
+        const std::int64_t size = m_Bottom.load(std::memory_order_seq_cst) - m_Top.load(std::memory_order_seq_cst);
+
+        return size > 0 ? static_cast<std::size_t>(size) : 0u;
+    }
+
+private:
+    struct Buffer
+    {
+        std::size_t                     Capacity;
+        std::size_t                     Mask;
+        std::unique_ptr<std::atomic<T>[]> Elements;
+
+        explicit Buffer(std::size_t capacity)
+            : Capacity{ capacity }, Mask{ capacity - 1 }, Elements{ std::make_unique<std::atomic<T>[]>(capacity) }
+        {}
+
+        T    Get(std::int64_t index) const  { return Elements[static_cast<std::size_t>(index) & Mask].load(std::memory_order_relaxed); }
+        void Put(std::int64_t index, T value) { Elements[static_cast<std::size_t>(index) & Mask].store(value, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<std::int64_t> m_Top = 0;
+    alignas(64) std::atomic<std::int64_t> m_Bottom = 0;
+    alignas(64) std::atomic<Buffer*>      m_Buffer = nullptr;
+
+    // Owner thread only.
+    std::vector<std::unique_ptr<Buffer>> m_Buffers;
+
+    Buffer* Grow(Buffer* buffer, std::int64_t b, std::int64_t t)
+    {
+        auto grown = std::make_unique<Buffer>(buffer->Capacity * 2);
+
+        for (std::int64_t i = t; i < b; i++) grown->Put(i, buffer->Get(i));
+
+        Buffer* grown_ptr = grown.get();
+
+        m_Buffers.push_back(std::move(grown));
+
+        m_Buffer.store(grown_ptr, std::memory_order_release);
+
+        return grown_ptr;
+    }
+};
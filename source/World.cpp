@@ -1,5 +1,6 @@
 #include "World.hpp"
 
+#include <cmath>
 #include <memory>
 #include <unordered_map>
 #include "Graphics_Camera.hpp"
@@ -16,19 +17,23 @@ namespace
     std::unique_ptr<World_ChunkManager> ChunkManager;
 }
 
-void World_Initialize()
+void World_Initialize(TaskScheduler& scheduler)
 {
-    ChunkManager = std::make_unique<World_ChunkManager>();
+    ChunkManager = std::make_unique<World_ChunkManager>(scheduler);
 }
 
 void World_Terminate()
 {
-
+    // Before the scheduler it runs jobs on.
+    ChunkManager.reset();
 }
 
 void World_Update(const Camera& camera)
 {
-    ChunkManager->SetCenterChunk_MainThread(World_FromGlobalToChunkID(camera.GetPosition()));
+    // Horizontal half field of view, widened a little so chunks straddling the edge of the view still count as visible.
+    const float view_half_angle = std::atan(std::tan(camera.GetFovY() * 0.5f) * camera.GetAspectRatio()) + glm::radians(10.0f);
+
+    ChunkManager->SetCenterChunk_MainThread(World_FromGlobalToChunkID(camera.GetPosition()), camera.GetFront(), view_half_angle);
 }
 
 float World_GetSunlightIntensity()
@@ -45,22 +50,34 @@ World_Block World_GetBlockAt(World_GlobalXYZ global)
 {
     if (global.y < 0 || global.y >= World_HEIGHT) return World_Block{ World_Block_ID::AIR };
 
-    auto chunk = World_GetChunkAt(global);
+    // Read from the chunk's snapshot, consistent while workers write the chunk. No snapshot reads as air.
+    const World_ChunkSnapshot* snapshot = ChunkManager->GetChunkSnapshotAt(global);
 
-    if (chunk == nullptr) return World_Block{ World_Block_ID::AIR };
+    if (snapshot == nullptr) return World_Block{ World_Block_ID::AIR };
 
-    return chunk->GetBlockAt(World_FromGlobalToLocal(global));
+    return snapshot->Storage->GetBlockAt(World_FromGlobalToLocal(global));
+}
+
+bool World_IsAirAt(World_GlobalXYZ global)
+{
+    if (global.y < 0 || global.y >= World_HEIGHT) return true;
+
+    const World_ChunkSnapshot* snapshot = ChunkManager->GetChunkSnapshotAt(global);
+
+    if (snapshot == nullptr) return true;
+
+    return snapshot->Storage->IsAirAt(World_FromGlobalToLocal(global));
 }
 
 World_Light World_GetLightAt(World_GlobalXYZ global)
 {
     if (global.y < 0 || global.y >= World_HEIGHT) return World_LIGHT_LEVEL_MIN;
 
-    auto chunk = World_GetChunkAt(global);
+    const World_ChunkSnapshot* snapshot = ChunkManager->GetChunkSnapshotAt(global);
 
-    if (chunk == nullptr) return World_LIGHT_LEVEL_MIN;
+    if (snapshot == nullptr) return World_LIGHT_LEVEL_MIN;
 
-    return chunk->GetLightAt(World_FromGlobalToLocal(global));
+    return snapshot->Storage->GetLightAt(World_FromGlobalToLocal(global));
 }
 
 const World_Chunk* World_GetChunkAt(World_GlobalXYZ global)
@@ -77,6 +94,11 @@ const World_ChunkManager& World_GetChunkManager()
     return *ChunkManager;
 }
 
+std::vector<World_Chunk_ID> World_TakeUnloadedChunkIDs()
+{
+    return ChunkManager->TakeUnloadedChunkIDs_MainThread();
+}
+
 void World_SetRenderDistance(std::size_t render_distance)
 {
     ChunkManager->SetRenderDistance(render_distance);
@@ -90,7 +112,7 @@ std::optional<std::pair<World_GlobalXYZ, World_Block_Face>> World_CastRay(glm::v
 
     if (ray_origin.y < 0.0f || ray_origin.y >= static_cast<float>(World_HEIGHT)) return std::nullopt;
 
-    if (World_GetBlockAt(World_GlobalXYZ(ray_origin)) != World_Block(World_Block_ID::AIR)) return std::nullopt;
+    if (!World_IsAirAt(World_GlobalXYZ(ray_origin))) return std::nullopt;
 
     World_GlobalXYZ current_voxel_position = World_GlobalXYZ(glm::floor(ray_origin));
 
@@ -138,7 +160,7 @@ std::optional<std::pair<World_GlobalXYZ, World_Block_Face>> World_CastRay(glm::v
             entered_face = step_z == 1 ? World_Block_Face::ZN : World_Block_Face::ZP;
         }
 
-        if (World_GetBlockAt(World_GlobalXYZ(current_voxel_position)).ID != World_Block_ID::AIR)
+        if (!World_IsAirAt(World_GlobalXYZ(current_voxel_position)))
         {
             return std::make_pair(World_GlobalXYZ(current_voxel_position), entered_face);
         }
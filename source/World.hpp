@@ -2,28 +2,34 @@
 
 #include <utility>
 #include <optional>
+#include <vector>
 #include "World_Coordinate.hpp"
 #include "World_ChunkManager.hpp"
 #include "World_Block.hpp"
 #include "Utility_Array2D.hpp"
 
 class Camera;
+class TaskScheduler;
 struct World_Chunk;
 
-void                    World_Initialize();
+void                    World_Initialize(TaskScheduler& scheduler);
 void                    World_Terminate();
 void                    World_Update(const Camera& camera);
 
 float                   World_GetSunlightIntensity();
 glm::vec3               World_GetSkyColor();
 
+// Read from chunk snapshots, callable from any thread. Unloaded chunks read as air.
 World_Block             World_GetBlockAt(World_GlobalXYZ global);
+bool                    World_IsAirAt(World_GlobalXYZ global);
 World_Light             World_GetLightAt(World_GlobalXYZ global);
 
 const World_Chunk*      World_GetChunkAt(World_GlobalXYZ global);
 
 const World_ChunkManager& World_GetChunkManager();
 
+std::vector<World_Chunk_ID> World_TakeUnloadedChunkIDs();
+
 void World_SetRenderDistance(std::size_t render_distance);
 
 std::optional<std::pair<World_GlobalXYZ, World_Block_Face>> World_CastRay(glm::vec3 ray_origin, glm::vec3 ray_direction, float ray_length);
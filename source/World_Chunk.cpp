@@ -1,122 +1,478 @@
 #include "World_Chunk.hpp"
 
+#include <cassert>
 #include <algorithm>
+#include <mutex>
+#include <vector>
+#include "Utility_ObjectPool.hpp"
 
-World_Block World_Chunk::GetBlockAt(World_LocalXYZ local) const
+namespace
 {
-    return Storage->Blocks.At(local.x, local.y, local.z);
+    constexpr int SectionOf(int local_y)     { return local_y / World_CHUNK_SECTION_Y_SIZE; }
+    constexpr int SectionLocalY(int local_y) { return local_y % World_CHUNK_SECTION_Y_SIZE; }
+
+    // Runs of n blocks along y, contiguous when y is stored first.
+    template<typename A>
+    constexpr bool IsYContiguous = A::Order == Array3DStoreOrder::YXZ || A::Order == Array3DStoreOrder::YZX;
+
+    template<typename A>
+    void FillY(A& to, int x, int y, int z, int n, World_Block block)
+    {
+        if constexpr (IsYContiguous<A>) std::fill_n(&to.At(x, y, z), n, block);
+        else for (int i = 0; i < n; i++) to.At(x, y + i, z) = block;
+    }
+
+    template<typename A, typename B>
+    void CopyY(const A& from, int fx, int fy, int fz, B& to, int tx, int ty, int tz, int n)
+    {
+        if constexpr (IsYContiguous<A> && IsYContiguous<B>) std::copy_n(&from.At(fx, fy, fz), n, &to.At(tx, ty, tz));
+        else for (int i = 0; i < n; i++) to.At(tx, ty + i, tz) = from.At(fx, fy + i, fz);
+    }
 }
 
-World_Light World_Chunk::GetLightAt(World_LocalXYZ local) const
+namespace
 {
-    return Storage->Lights.At(local.x, local.y, local.z);
+    // Pool capacities, beyond which objects come from the heap.
+    // Arenas are reserved up front but only touched as used: light data is 4 KB per section, the rest is small.
+    constexpr std::size_t STORAGE_POOL_CAPACITY       = 16384;
+    constexpr std::size_t SECTION_BLOCK_POOL_CAPACITY = 65536;
+    constexpr std::size_t SECTION_LIGHT_POOL_CAPACITY = 32768;
+
+    // Pools are never destroyed, chunks may be freed during static destruction.
+    template<typename T, std::size_t Capacity>
+    ObjectPool<T>& GetPool()
+    {
+        static ObjectPool<T>& pool = *new ObjectPool<T>(Capacity);
+
+        return pool;
+    }
+
+    ObjectPool<World_Chunk_Storage>&          StoragePool()      { return GetPool<World_Chunk_Storage, STORAGE_POOL_CAPACITY>(); }
+    ObjectPool<World_Chunk_SectionBlockData>& SectionBlockPool() { return GetPool<World_Chunk_SectionBlockData, SECTION_BLOCK_POOL_CAPACITY>(); }
+    ObjectPool<World_Chunk_SectionLightData>& SectionLightPool() { return GetPool<World_Chunk_SectionLightData, SECTION_LIGHT_POOL_CAPACITY>(); }
+
+    // Allocates a section's data from its uniform value, unless already allocated.
+    // Lighting may write into the same neighbour chunk from several workers, the first one publishes.
+    template<typename T, typename V>
+    T* GetOrAllocateSectionData(std::atomic<T*>& slot, V uniform, ObjectPool<T>& pool)
+    {
+        T* current = slot.load(std::memory_order_acquire);
+
+        if (current != nullptr) return current;
+
+        T* allocated = pool.Allocate();
+        allocated->Fill(uniform);
+
+        if (slot.compare_exchange_strong(current, allocated, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return allocated;
+        }
+
+        pool.Release(allocated);
+
+        return current;
+    }
+
+    void CopySectionData(World_Chunk_SectionBlockData& to, const World_Chunk_SectionBlockData& from) { to.CopyFrom(from); }
+    void CopySectionData(World_Chunk_SectionLightData& to, const World_Chunk_SectionLightData& from) { to = from; }
+
+    // Same as GetOrAllocateSectionData, cloning the section first while it is shared with a snapshot.
+    // The shared data stays alive until the next snapshot, for readers that loaded it before the clone was published.
+    template<typename T, typename V>
+    T* GetWritableSectionData(std::atomic<T*>& slot, const std::shared_ptr<const T>& shared, V uniform, ObjectPool<T>& pool)
+    {
+        T* current = slot.load(std::memory_order_acquire);
+
+        if (current == nullptr || current != shared.get()) return GetOrAllocateSectionData(slot, uniform, pool);
+
+        T* clone = pool.Allocate();
+        CopySectionData(*clone, *current);
+
+        if (slot.compare_exchange_strong(current, clone, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return clone;
+        }
+
+        pool.Release(clone);
+
+        return current;
+    }
+
+    // Section data of a new snapshot: the previous snapshot's if unchanged since, otherwise handed over.
+    template<typename T>
+    std::shared_ptr<const T> ShareSectionData(std::atomic<T*>& slot, std::shared_ptr<const T>& shared, ObjectPool<T>& pool)
+    {
+        T* current = slot.load(std::memory_order_acquire);
+
+        if (current == nullptr)       return nullptr;
+        if (current == shared.get()) return shared;
+
+        auto release = [&pool](const T* data) { pool.Release(const_cast<T*>(data)); };
+
+        shared = std::shared_ptr<const T>(current, release);
+
+        return shared;
+    }
+
+    template<typename T>
+    World_Chunk_PoolOccupancy GetOccupancy(const ObjectPool<T>& pool)
+    {
+        return World_Chunk_PoolOccupancy{ pool.GetUsedCount(), pool.GetCapacity(), pool.GetOverflowCount(), pool.GetCommittedBytes() };
+    }
+}
+
+void World_Chunk_SectionBlockData::Set(std::size_t x, std::size_t y, std::size_t z, World_Block block)
+{
+    Palette.Set(x, y, z, block);
+
+    const auto bit = static_cast<std::uint16_t>(1u << y);
+
+    if (block.IsOpaque()) Opacity.At(x, z) |= bit;
+    else                  Opacity.At(x, z) &= static_cast<std::uint16_t>(~bit);
+
+    if (block.ID != World_Block_ID::AIR && block.IsTransparent()) HasTransparentBlocks = true;
+}
+
+void World_Chunk_SectionBlockData::Fill(World_Block block)
+{
+    Palette.Fill(block);
+    Opacity.Fill(block.IsOpaque() ? 0xFFFF : 0x0000);
+    HasTransparentBlocks = block.ID != World_Block_ID::AIR && block.IsTransparent();
+}
+
+void World_Chunk_SectionBlockData::Encode(const FlatArray& blocks)
+{
+    Palette.Encode(blocks);
+
+    HasTransparentBlocks = false;
+
+    for (std::size_t z = 0; z < World_CHUNK_Z_SIZE; z++)
+    for (std::size_t x = 0; x < World_CHUNK_X_SIZE; x++)
+    {
+        std::uint16_t mask = 0;
+
+        for (std::size_t y = 0; y < World_CHUNK_SECTION_Y_SIZE; y++)
+        {
+            const World_Block block = blocks.At(x, y, z);
+
+            mask |= static_cast<std::uint16_t>(block.IsOpaque() ? 1u << y : 0u);
+
+            HasTransparentBlocks |= block.ID != World_Block_ID::AIR && block.IsTransparent();
+        }
+
+        Opacity.At(x, z) = mask;
+    }
+}
+
+void World_Chunk_SectionBlockData::CopyFrom(const World_Chunk_SectionBlockData& other)
+{
+    thread_local FlatArray blocks;
+
+    other.Decode(blocks);
+    Palette.Encode(blocks);
+
+    Opacity              = other.Opacity;
+    HasTransparentBlocks = other.HasTransparentBlocks;
+}
+
+World_Chunk_Storage::~World_Chunk_Storage()
+{
+    // Shared sections are released along with their last reference.
+    for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+    {
+        auto* blocks = SectionBlocks[s].load(std::memory_order_relaxed);
+        auto* lights = SectionLights[s].load(std::memory_order_relaxed);
+
+        if (blocks != SharedBlocks[s].get()) SectionBlockPool().Release(blocks);
+        if (lights != SharedLights[s].get()) SectionLightPool().Release(lights);
+    }
+}
+
+void World_Chunk_StorageDeleter::operator()(World_Chunk_Storage* storage) const
+{
+    StoragePool().Release(storage);
+}
+
+World_Chunk_StoragePtr World_Chunk_AllocateStorage()
+{
+    return World_Chunk_StoragePtr{ StoragePool().Allocate() };
+}
+
+namespace
+{
+    // Chunks are created and destroyed by the main thread, rarely enough for a mutex.
+    struct StateSlotTable
+    {
+        std::mutex                         Mutex;
+        std::vector<World_ChunkStatePage*> Pages;
+        std::vector<World_ChunkStateSlot>  FreeSlots;
+    };
+
+    // Never destroyed, chunks may be freed during static destruction.
+    StateSlotTable& StateSlots()
+    {
+        static StateSlotTable& table = *new StateSlotTable;
+
+        return table;
+    }
+}
+
+World_ChunkStateSlot World_Chunk_AllocateStateSlot()
+{
+    auto& table = StateSlots();
+
+    World_ChunkStateSlot slot;
+
+    {
+        std::lock_guard<std::mutex> lock{ table.Mutex };
+
+        if (table.FreeSlots.empty())
+        {
+            auto* page = new World_ChunkStatePage;
+            table.Pages.push_back(page);
+
+            // Handed out in increasing index order, so chunks created together are packed together.
+            for (std::uint32_t i = World_ChunkStatePage::SLOT_COUNT; i-- > 0;) table.FreeSlots.push_back(World_ChunkStateSlot{ page, i });
+        }
+
+        slot = table.FreeSlots.back();
+        table.FreeSlots.pop_back();
+    }
+
+    World_ChunkStatePage& page = *slot.Page;
+
+    page.Stage[slot.Index].store(World_Chunk_Stage::Empty, std::memory_order_relaxed);
+    page.EnqueuedStates[slot.Index].store(0, std::memory_order_relaxed);
+    page.NeighboursSet[slot.Index].store(false, std::memory_order_relaxed);
+    page.Retired[slot.Index].store(false, std::memory_order_relaxed);
+    page.PendingGenerations[slot.Index].store(0, std::memory_order_relaxed);
+    page.PendingLocalLightings[slot.Index].store(0, std::memory_order_relaxed);
+    page.StorageVersion[slot.Index].store(0, std::memory_order_relaxed);
+    page.PinCount[slot.Index].store(0, std::memory_order_relaxed);
+
+    return slot;
+}
+
+void World_Chunk_ReleaseStateSlot(World_ChunkStateSlot slot)
+{
+    auto& table = StateSlots();
+
+    std::lock_guard<std::mutex> lock{ table.Mutex };
+
+    table.FreeSlots.push_back(slot);
+}
+
+World_Chunk_PoolOccupancy World_Chunk_GetStoragePoolOccupancy()      { return GetOccupancy(StoragePool()); }
+World_Chunk_PoolOccupancy World_Chunk_GetSectionBlockPoolOccupancy() { return GetOccupancy(SectionBlockPool()); }
+World_Chunk_PoolOccupancy World_Chunk_GetSectionLightPoolOccupancy() { return GetOccupancy(SectionLightPool()); }
+
+World_Block World_Chunk_Storage::GetBlockAt(World_LocalXYZ local) const
+{
+    const int s = SectionOf(local.y);
+
+    if (const auto* blocks = GetSectionBlocks(s)) return blocks->At(local.x, SectionLocalY(local.y), local.z);
+
+    return UniformBlocks[s];
+}
+
+World_Light World_Chunk_Storage::GetLightAt(World_LocalXYZ local) const
+{
+    const int s = SectionOf(local.y);
+
+    if (const auto* lights = GetSectionLights(s)) return lights->At(local.x, SectionLocalY(local.y), local.z);
+
+    return UniformLights[s];
 }
 
 World_Light World_Chunk::GetSunlightAt(World_LocalXYZ local) const
 {
-    return World_ExtractSunlight(Storage->Lights.At(local.x, local.y, local.z));
+    return World_ExtractSunlight(GetLightAt(local));
 }
 
 World_Light World_Chunk::GetPointlightAt(World_LocalXYZ local) const
 {
-    return World_ExtractPointlight(Storage->Lights.At(local.x, local.y, local.z));
+    return World_ExtractPointlight(GetLightAt(local));
 }
 
 void World_Chunk::SetBlockAt(World_LocalXYZ local, World_Block block)
 {
-    Storage->Blocks.At(local.x, local.y, local.z) = block;
+    const int s = SectionOf(local.y);
+
+    if (Storage->GetSectionBlocks(s) == nullptr && Storage->UniformBlocks[s] == block) return;
+
+    GetWritableSectionData(Storage->SectionBlocks[s], Storage->SharedBlocks[s], Storage->UniformBlocks[s], SectionBlockPool())->Set(local.x, SectionLocalY(local.y), local.z, block);
 }
 
 void World_Chunk::SetLightAt(World_LocalXYZ local, World_Light sunlight, World_Light pointlight)
 {
-    Storage->Lights.At(local.x, local.y, local.z) = ((sunlight << 0) & 0x0F) | ((pointlight << 4) & 0xF0);
+    const World_Light light = ((sunlight << 0) & 0x0F) | ((pointlight << 4) & 0xF0);
+
+    const int s = SectionOf(local.y);
+
+    if (Storage->GetSectionLights(s) == nullptr && Storage->UniformLights[s] == light) return;
+
+    GetWritableSectionData(Storage->SectionLights[s], Storage->SharedLights[s], Storage->UniformLights[s], SectionLightPool())->At(local.x, SectionLocalY(local.y), local.z) = light;
 }
 
 void World_Chunk::SetSunlightAt(World_LocalXYZ local, World_Light sunlight)
 {
-    auto& light = Storage->Lights.At(local.x, local.y, local.z);
-
-    light = (light & 0xF0) | ((sunlight << 0) & 0x0F);
+    SetLightAt(local, sunlight, GetPointlightAt(local));
 }
 
 void World_Chunk::SetPointlightAt(World_LocalXYZ local, World_Light pointlight)
 {
-    auto& light = Storage->Lights.At(local.x, local.y, local.z);
+    SetLightAt(local, GetSunlightAt(local), pointlight);
+}
+
+std::optional<World_Block> World_Chunk_Storage::GetSectionUniformBlock(int section) const
+{
+    const auto* blocks = GetSectionBlocks(section);
+
+    if (blocks == nullptr) return UniformBlocks[section];
+
+    if (blocks->GetBitsPerElement() == 0) return blocks->At(0, 0, 0);
+
+    return std::nullopt;
+}
+
+std::optional<World_Light> World_Chunk_Storage::GetSectionUniformLight(int section) const
+{
+    if (GetSectionLights(section) == nullptr) return UniformLights[section];
+
+    return std::nullopt;
+}
+
+std::uint16_t World_Chunk_Storage::GetSectionOpacity(int section, int local_x, int local_z) const
+{
+    if (const auto* blocks = GetSectionBlocks(section)) return blocks->Opacity.At(local_x, local_z);
+
+    return UniformBlocks[section].IsOpaque() ? 0xFFFF : 0x0000;
+}
+
+bool World_Chunk_Storage::SectionHasTransparentBlocks(int section) const
+{
+    if (const auto* blocks = GetSectionBlocks(section)) return blocks->HasTransparentBlocks;
+
+    const World_Block uniform = UniformBlocks[section];
+
+    return uniform.ID != World_Block_ID::AIR && uniform.IsTransparent();
+}
+
+bool World_Chunk_Storage::IsOpaqueAt(World_LocalXYZ local) const
+{
+    return (GetSectionOpacity(SectionOf(local.y), local.x, local.z) >> SectionLocalY(local.y)) & 1u;
+}
 
-    light = (light & 0x0F) | ((pointlight << 4) & 0xF0);
+bool World_Chunk_Storage::IsAirAt(World_LocalXYZ local) const
+{
+    if (IsOpaqueAt(local)) return false;
+
+    if (!SectionHasTransparentBlocks(SectionOf(local.y))) return true;
+
+    return GetBlockAt(local).ID == World_Block_ID::AIR;
 }
 
-int World_Chunk::GetHeightAt(int local_x, int local_z) const
+void World_Chunk::EncodeSectionBlocks(int section, const World_Chunk_FlatSectionBlockData& blocks, World_Light light)
 {
-    return Storage->Heights.At(local_x, local_z);
+    Storage->UniformLights[section] = light;
+
+    const World_Block first = blocks.At(0, 0, 0);
+
+    const bool uniform = std::all_of(blocks.begin(), blocks.end(), [first](World_Block block) { return block == first; });
+
+    Storage->UniformBlocks[section] = first;
+
+    if (uniform) return;
+
+    GetOrAllocateSectionData(Storage->SectionBlocks[section], first, SectionBlockPool())->Encode(blocks);
 }
 
-int World_Chunk::GetMaxHeight() const
+int World_Chunk_Storage::GetMaxHeight() const
 {
-    return *std::max_element(Storage->Heights.begin(), Storage->Heights.end());;
+    return *std::max_element(Heights.begin(), Heights.end());
+}
+
+World_ChunkNeighbourhood World_Chunk::GetNeighbourhood() const
+{
+    World_ChunkNeighbourhood area{ Storage.get() };
+
+    for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
+    {
+        const World_Chunk* neighbour = Neighbours[n].load(std::memory_order_acquire);
+
+        area.Neighbours[n] = (neighbour != nullptr) ? neighbour->Storage.get() : nullptr;
+    }
+
+    return area;
 }
 
 std::array<World_Block, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
-World_Chunk::GetCrossNeighbourBlocksAt(World_LocalXYZ local) const
+World_ChunkNeighbourhood::GetCrossNeighbourBlocksAt(World_LocalXYZ local) const
 {
     int& x = local.x;
     int& y = local.y;
     int& z = local.z;
 
-    World_Chunk* cxn = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZ0];
-    World_Chunk* cxp = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZ0];
-    World_Chunk* czn = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZN];
-    World_Chunk* czp = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZP];
+    const World_Chunk_Storage* cxn = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZ0];
+    const World_Chunk_Storage* cxp = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZ0];
+    const World_Chunk_Storage* czn = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZN];
+    const World_Chunk_Storage* czp = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZP];
+
+    constexpr auto air = World_Block(World_Block_ID::AIR);
+
+    auto B = [air](const World_Chunk_Storage* c, World_LocalXYZ l) { return (c != nullptr) ? c->GetBlockAt(l) : air; };
 
     return std::array<World_Block, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
     {
-        (x != 0)                        ? GetBlockAt(World_LocalXYZ(x - 1, y, z)) : cxn->GetBlockAt(World_LocalXYZ(World_CHUNK_X_SIZE - 1, y, z)),
-        (x != World_CHUNK_X_SIZE - 1)   ? GetBlockAt(World_LocalXYZ(x + 1, y, z)) : cxp->GetBlockAt(World_LocalXYZ(0, y, z)),
-        (y != 0)                        ? GetBlockAt(World_LocalXYZ(x, y - 1, z)) : World_Block(World_Block_ID::AIR),
-        (y != World_CHUNK_Y_SIZE - 1)   ? GetBlockAt(World_LocalXYZ(x, y + 1, z)) : World_Block(World_Block_ID::AIR),
-        (z != 0)                        ? GetBlockAt(World_LocalXYZ(x, y, z - 1)) : czn->GetBlockAt(World_LocalXYZ(x, y, World_CHUNK_Z_SIZE - 1)),
-        (z != World_CHUNK_Z_SIZE - 1)   ? GetBlockAt(World_LocalXYZ(x, y, z + 1)) : czp->GetBlockAt(World_LocalXYZ(x, y, 0))
+        (x != 0)                        ? Center->GetBlockAt(World_LocalXYZ(x - 1, y, z)) : B(cxn, World_LocalXYZ(World_CHUNK_X_SIZE - 1, y, z)),
+        (x != World_CHUNK_X_SIZE - 1)   ? Center->GetBlockAt(World_LocalXYZ(x + 1, y, z)) : B(cxp, World_LocalXYZ(0, y, z)),
+        (y != 0)                        ? Center->GetBlockAt(World_LocalXYZ(x, y - 1, z)) : air,
+        (y != World_CHUNK_Y_SIZE - 1)   ? Center->GetBlockAt(World_LocalXYZ(x, y + 1, z)) : air,
+        (z != 0)                        ? Center->GetBlockAt(World_LocalXYZ(x, y, z - 1)) : B(czn, World_LocalXYZ(x, y, World_CHUNK_Z_SIZE - 1)),
+        (z != World_CHUNK_Z_SIZE - 1)   ? Center->GetBlockAt(World_LocalXYZ(x, y, z + 1)) : B(czp, World_LocalXYZ(x, y, 0))
     };
 }
 
 std::array<World_Light, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
-World_Chunk::GetCrossNeighbourLightsAt(World_LocalXYZ local) const
+World_ChunkNeighbourhood::GetCrossNeighbourLightsAt(World_LocalXYZ local) const
 {
     int& x = local.x;
     int& y = local.y;
     int& z = local.z;
 
-    World_Chunk* cxn = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZ0];
-    World_Chunk* cxp = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZ0];
-    World_Chunk* czn = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZN];
-    World_Chunk* czp = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZP];
+    const World_Chunk_Storage* cxn = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZ0];
+    const World_Chunk_Storage* cxp = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZ0];
+    const World_Chunk_Storage* czn = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZN];
+    const World_Chunk_Storage* czp = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZP];
+
+    auto L = [](const World_Chunk_Storage* c, World_LocalXYZ l) { return (c != nullptr) ? c->GetLightAt(l) : World_LIGHT_LEVEL_MIN; };
 
     return std::array<World_Light, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
     {
-        (x != 0)                        ? GetLightAt(World_LocalXYZ(x - 1, y, z)) : cxn->GetLightAt(World_LocalXYZ(World_CHUNK_X_SIZE - 1, y, z)),
-        (x != World_CHUNK_X_SIZE - 1)   ? GetLightAt(World_LocalXYZ(x + 1, y, z)) : cxp->GetLightAt(World_LocalXYZ(0, y, z)),
-        (y != 0)                        ? GetLightAt(World_LocalXYZ(x, y - 1, z)) : World_LIGHT_LEVEL_MIN,
-        (y != World_CHUNK_Y_SIZE - 1)   ? GetLightAt(World_LocalXYZ(x, y + 1, z)) : World_LIGHT_LEVEL_SUN,
-        (z != 0)                        ? GetLightAt(World_LocalXYZ(x, y, z - 1)) : czn->GetLightAt(World_LocalXYZ(x, y, World_CHUNK_Z_SIZE - 1)),
-        (z != World_CHUNK_Z_SIZE - 1)   ? GetLightAt(World_LocalXYZ(x, y, z + 1)) : czp->GetLightAt(World_LocalXYZ(x, y, 0))
+        (x != 0)                        ? Center->GetLightAt(World_LocalXYZ(x - 1, y, z)) : L(cxn, World_LocalXYZ(World_CHUNK_X_SIZE - 1, y, z)),
+        (x != World_CHUNK_X_SIZE - 1)   ? Center->GetLightAt(World_LocalXYZ(x + 1, y, z)) : L(cxp, World_LocalXYZ(0, y, z)),
+        (y != 0)                        ? Center->GetLightAt(World_LocalXYZ(x, y - 1, z)) : World_LIGHT_LEVEL_MIN,
+        (y != World_CHUNK_Y_SIZE - 1)   ? Center->GetLightAt(World_LocalXYZ(x, y + 1, z)) : World_LIGHT_LEVEL_SUN,
+        (z != 0)                        ? Center->GetLightAt(World_LocalXYZ(x, y, z - 1)) : L(czn, World_LocalXYZ(x, y, World_CHUNK_Z_SIZE - 1)),
+        (z != World_CHUNK_Z_SIZE - 1)   ? Center->GetLightAt(World_LocalXYZ(x, y, z + 1)) : L(czp, World_LocalXYZ(x, y, 0))
     };
 }
 
 std::array<World_Block, static_cast<std::size_t>(World_Block_WholeNeighbour::Count)>
-World_Chunk::GetWholeNeighbourBlocksAt(World_LocalXYZ local) const
+World_ChunkNeighbourhood::GetWholeNeighbourBlocksAt(World_LocalXYZ local) const
 {
     const int x = local.x;
     const int y = local.y;
     const int z = local.z;
 
-    const World_Chunk* cxn   = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZ0];
-    const World_Chunk* cxp   = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZ0];
-    const World_Chunk* czn   = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZN];
-    const World_Chunk* czp   = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZP];
-    const World_Chunk* cxnzn = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZN];
-    const World_Chunk* cxpzn = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZN];
-    const World_Chunk* cxnzp = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZP];
-    const World_Chunk* cxpzp = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZP];
+    const World_Chunk_Storage* cxn   = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZ0];
+    const World_Chunk_Storage* cxp   = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZ0];
+    const World_Chunk_Storage* czn   = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZN];
+    const World_Chunk_Storage* czp   = Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZP];
+    const World_Chunk_Storage* cxnzn = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZN];
+    const World_Chunk_Storage* cxpzn = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZN];
+    const World_Chunk_Storage* cxnzp = Neighbours[(std::size_t)World_Chunk_Neighbour::XNZP];
+    const World_Chunk_Storage* cxpzp = Neighbours[(std::size_t)World_Chunk_Neighbour::XPZP];
 
     constexpr auto air = World_Block(World_Block_ID::AIR);
 
@@ -130,9 +486,9 @@ World_Chunk::GetWholeNeighbourBlocksAt(World_LocalXYZ local) const
         const bool z_neg = (nz < 0);
         const bool z_pos = (nz >= World_CHUNK_Z_SIZE);
 
-        if (!x_neg && !x_pos && !z_neg && !z_pos) return GetBlockAt(World_LocalXYZ(nx, ny, nz));
+        if (!x_neg && !x_pos && !z_neg && !z_pos) return Center->GetBlockAt(World_LocalXYZ(nx, ny, nz));
 
-        const World_Chunk* c = this;
+        const World_Chunk_Storage* c = Center;
         int lx = nx;
         int lz = nz;
 
@@ -185,3 +541,346 @@ World_Chunk::GetWholeNeighbourBlocksAt(World_LocalXYZ local) const
         B(x + 1, y + 1, z + 1), // XpYpZp
     };
 }
+
+void World_Chunk_Storage::DecodeSectionBlocks(int section, World_Chunk_FlatSectionBlockData& out) const
+{
+    if (const auto* blocks = GetSectionBlocks(section))
+    {
+        blocks->Decode(out);
+        return;
+    }
+
+    out.Fill(UniformBlocks[section]);
+}
+
+void World_Chunk_Storage::DecodeBlocks(World_Chunk_FlatBlockData& out) const
+{
+    thread_local World_Chunk_FlatSectionBlockData blocks;
+
+    for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+    {
+        DecodeSectionBlocks(s, blocks);
+
+        for (int lz = 0; lz < World_CHUNK_Z_SIZE; lz++)
+        for (int lx = 0; lx < World_CHUNK_X_SIZE; lx++)
+        {
+            CopyY(blocks, lx, 0, lz, out, lx, s * World_CHUNK_SECTION_Y_SIZE, lz, World_CHUNK_SECTION_Y_SIZE);
+        }
+    }
+}
+
+void World_ChunkNeighbourhood::DecodePaddedBlocks(World_Chunk_PaddedBlockData& out) const
+{
+    constexpr auto air = World_Block(World_Block_ID::AIR);
+
+    thread_local World_Chunk_FlatSectionBlockData blocks;
+
+    for (int pz = 0; pz < World_CHUNK_Z_SIZE + 2; pz++)
+    for (int px = 0; px < World_CHUNK_X_SIZE + 2; px++)
+    {
+        out.At(px, 0, pz)                      = air;
+        out.At(px, World_CHUNK_Y_SIZE + 1, pz) = air;
+    }
+
+    for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+    {
+        const int y_base = s * World_CHUNK_SECTION_Y_SIZE;
+
+        if (auto uniform = Center->GetSectionUniformBlock(s))
+        {
+            for (int lz = 0; lz < World_CHUNK_Z_SIZE; lz++)
+            for (int lx = 0; lx < World_CHUNK_X_SIZE; lx++)
+            {
+                FillY(out, lx + 1, y_base + 1, lz + 1, World_CHUNK_SECTION_Y_SIZE, *uniform);
+            }
+
+            continue;
+        }
+
+        Center->DecodeSectionBlocks(s, blocks);
+
+        for (int lz = 0; lz < World_CHUNK_Z_SIZE; lz++)
+        for (int lx = 0; lx < World_CHUNK_X_SIZE; lx++)
+        {
+            CopyY(blocks, lx, 0, lz, out, lx + 1, y_base + 1, lz + 1, World_CHUNK_SECTION_Y_SIZE);
+        }
+    }
+
+    // Apron columns from the neighbours.
+    for (int pz = 0; pz < World_CHUNK_Z_SIZE + 2; pz++)
+    for (int px = 0; px < World_CHUNK_X_SIZE + 2; px++)
+    {
+        const int lx = px - 1;
+        const int lz = pz - 1;
+
+        if (lx >= 0 && lx < World_CHUNK_X_SIZE && lz >= 0 && lz < World_CHUNK_Z_SIZE) continue;
+
+        const int dx = (lx < 0) ? -1 : (lx >= World_CHUNK_X_SIZE) ? 1 : 0;
+        const int dz = (lz < 0) ? -1 : (lz >= World_CHUNK_Z_SIZE) ? 1 : 0;
+
+        const World_Chunk_Storage* c = nullptr;
+
+        for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
+        {
+            if (World_Chunk_NEIGHBOUR_OFFSETS[n].x == dx && World_Chunk_NEIGHBOUR_OFFSETS[n].z == dz) c = Neighbours[n];
+        }
+
+        if (c == nullptr)
+        {
+            FillY(out, px, 1, pz, World_CHUNK_Y_SIZE, air);
+            continue;
+        }
+
+        const int nx = lx - dx * World_CHUNK_X_SIZE;
+        const int nz = lz - dz * World_CHUNK_Z_SIZE;
+
+        for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+        {
+            const int y_base = s * World_CHUNK_SECTION_Y_SIZE;
+
+            if (auto uniform = c->GetSectionUniformBlock(s))
+            {
+                FillY(out, px, y_base + 1, pz, World_CHUNK_SECTION_Y_SIZE, *uniform);
+                continue;
+            }
+
+            for (int ly = y_base; ly < y_base + World_CHUNK_SECTION_Y_SIZE; ly++)
+            {
+                out.At(px, ly + 1, pz) = c->GetBlockAt(World_LocalXYZ(nx, ly, nz));
+            }
+        }
+    }
+}
+
+void World_ChunkNeighbourhood::DecodePaddedOpacity(World_Chunk_PaddedOpacityData& out) const
+{
+    constexpr int SECTIONS_PER_WORD = 64 / World_CHUNK_SECTION_Y_SIZE;
+
+    for (int pz = 0; pz < World_CHUNK_Z_SIZE + 2; pz++)
+    for (int px = 0; px < World_CHUNK_X_SIZE + 2; px++)
+    {
+        const int lx = px - 1;
+        const int lz = pz - 1;
+
+        const int dx = (lx < 0) ? -1 : (lx >= World_CHUNK_X_SIZE) ? 1 : 0;
+        const int dz = (lz < 0) ? -1 : (lz >= World_CHUNK_Z_SIZE) ? 1 : 0;
+
+        const World_Chunk_Storage* c = Center;
+
+        if (dx != 0 || dz != 0)
+        {
+            c = nullptr;
+
+            for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
+            {
+                if (World_Chunk_NEIGHBOUR_OFFSETS[n].x == dx && World_Chunk_NEIGHBOUR_OFFSETS[n].z == dz) c = Neighbours[n];
+            }
+        }
+
+        auto& column = out.At(px, pz);
+        column.fill(0);
+
+        if (c == nullptr) continue;
+
+        const int nx = lx - dx * World_CHUNK_X_SIZE;
+        const int nz = lz - dz * World_CHUNK_Z_SIZE;
+
+        for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+        {
+            const std::uint64_t mask = c->GetSectionOpacity(s, nx, nz);
+
+            column[s / SECTIONS_PER_WORD] |= mask << (World_CHUNK_SECTION_Y_SIZE * (s % SECTIONS_PER_WORD));
+        }
+    }
+}
+
+std::array<World_Block, static_cast<std::size_t>(World_Block_WholeNeighbour::Count)>
+World_Chunk_GetWholeNeighbourBlocksAt(const World_Chunk_PaddedBlockData& blocks, World_LocalXYZ local)
+{
+    const int x = local.x + 1;
+    const int y = local.y + 1;
+    const int z = local.z + 1;
+
+    auto B = [&blocks](int px, int py, int pz) { return blocks.At(px, py, pz); };
+
+    return
+    {
+        B(x - 1, y,     z),     // XnYoZo
+        B(x + 1, y,     z),     // XpYoZo
+        B(x,     y - 1, z),     // XoYnZo
+        B(x,     y + 1, z),     // XoYpZo
+        B(x,     y,     z - 1), // XoYoZn
+        B(x,     y,     z + 1), // XoYoZp
+
+        B(x - 1, y,     z - 1), // XnYoZn
+        B(x + 1, y,     z - 1), // XpYoZn
+        B(x - 1, y,     z + 1), // XnYoZp
+        B(x + 1, y,     z + 1), // XpYoZp
+
+        B(x,     y - 1, z - 1), // XoYnZn
+        B(x,     y + 1, z - 1), // XoYpZn
+        B(x,     y - 1, z + 1), // XoYnZp
+        B(x,     y + 1, z + 1), // XoYpZp
+
+        B(x - 1, y - 1, z),     // XnYnZo
+        B(x + 1, y - 1, z),     // XpYnZo
+        B(x - 1, y + 1, z),     // XnYpZo
+        B(x + 1, y + 1, z),     // XpYpZo
+
+        B(x - 1, y - 1, z - 1), // XnYnZn
+        B(x + 1, y - 1, z - 1), // XpYnZn
+        B(x - 1, y + 1, z - 1), // XnYpZn
+        B(x + 1, y + 1, z - 1), // XpYpZn
+        B(x - 1, y - 1, z + 1), // XnYnZp
+        B(x + 1, y - 1, z + 1), // XpYnZp
+        B(x - 1, y + 1, z + 1), // XnYpZp
+        B(x + 1, y + 1, z + 1), // XpYpZp
+    };
+}
+
+std::size_t World_Chunk_Storage::GetSectionMemoryUsage() const
+{
+    std::size_t usage = 0;
+
+    for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+    {
+        if (const auto* blocks = GetSectionBlocks(s)) usage += sizeof(World_Chunk_SectionBlockData) + blocks->GetHeapUsage();
+        if (GetSectionLights(s) != nullptr)           usage += sizeof(World_Chunk_SectionLightData);
+    }
+
+    return usage;
+}
+
+std::size_t World_Chunk::GetMemoryUsage() const
+{
+    if (!Storage) return sizeof(World_Chunk);
+
+    std::size_t usage = sizeof(World_Chunk) + sizeof(World_Chunk_Storage) + Storage->GetSectionMemoryUsage();
+
+    // Sections of the snapshot not shared with the storage.
+    if (const World_ChunkSnapshotPtr snapshot = Snapshot.load(std::memory_order_acquire))
+    {
+        const World_Chunk_Storage& frozen = *snapshot->Storage;
+
+        usage += sizeof(World_ChunkSnapshot) + sizeof(World_Chunk_Storage);
+
+        for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+        {
+            const auto* blocks = frozen.GetSectionBlocks(s);
+            const auto* lights = frozen.GetSectionLights(s);
+
+            if (blocks != nullptr && blocks != Storage->GetSectionBlocks(s)) usage += sizeof(World_Chunk_SectionBlockData) + blocks->GetHeapUsage();
+            if (lights != nullptr && lights != Storage->GetSectionLights(s)) usage += sizeof(World_Chunk_SectionLightData);
+        }
+    }
+
+    return usage;
+}
+
+void World_Chunk::PublishSnapshot(std::uint32_t version)
+{
+    auto snapshot = std::make_shared<World_ChunkSnapshot>();
+
+    snapshot->Version = version;
+    snapshot->Storage = World_Chunk_AllocateStorage();
+
+    World_Chunk_Storage& frozen = *snapshot->Storage;
+
+    frozen.UniformBlocks = Storage->UniformBlocks;
+    frozen.UniformLights = Storage->UniformLights;
+    frozen.Heights       = Storage->Heights;
+
+    for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+    {
+        frozen.SharedBlocks[s] = ShareSectionData(Storage->SectionBlocks[s], Storage->SharedBlocks[s], SectionBlockPool());
+        frozen.SharedLights[s] = ShareSectionData(Storage->SectionLights[s], Storage->SharedLights[s], SectionLightPool());
+
+        // Never written through: the snapshot is only reachable as const.
+        frozen.SectionBlocks[s].store(const_cast<World_Chunk_SectionBlockData*>(frozen.SharedBlocks[s].get()), std::memory_order_relaxed);
+        frozen.SectionLights[s].store(const_cast<World_Chunk_SectionLightData*>(frozen.SharedLights[s].get()), std::memory_order_relaxed);
+    }
+
+    Snapshot.store(std::move(snapshot), std::memory_order_release);
+}
+
+bool World_Chunk::IsNeighbourhoodLit() const
+{
+    if (!NeighboursSet().load(std::memory_order_acquire)) return false;
+    if (Stage().load(std::memory_order_acquire) < World_Chunk_Stage::NeighbourLightingComplete) return false;
+
+    for (const auto& slot : Neighbours)
+    {
+        const World_Chunk* neighbour = slot.load(std::memory_order_acquire);
+
+        if (neighbour == nullptr || neighbour->Stage().load(std::memory_order_acquire) < World_Chunk_Stage::NeighbourLightingComplete) return false;
+    }
+
+    return true;
+}
+
+std::optional<World_ChunkSnapshotView> World_Chunk::TakeSnapshotView()
+{
+    World_ChunkSnapshotView view{ this, Snapshot.load(std::memory_order_acquire) };
+
+    if (!view.Center) return std::nullopt;
+
+    view.Area.Center = view.Center->Storage.get();
+
+    for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
+    {
+        const World_Chunk* neighbour = Neighbours[n].load(std::memory_order_acquire);
+
+        if (neighbour == nullptr) continue;
+
+        view.Neighbours[n] = neighbour->Snapshot.load(std::memory_order_acquire);
+
+        if (view.Neighbours[n]) view.Area.Neighbours[n] = view.Neighbours[n]->Storage.get();
+    }
+
+    return view;
+}
+
+namespace
+{
+    EpochReclamation ChunkReclamation;
+
+    // Registered on the thread's first guard, slot given back when the thread exits.
+    // Depth counts the thread's nested guards, only the outermost one enters and leaves.
+    struct ReclamationSlot
+    {
+        static constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+
+        std::size_t Index = NONE;
+        std::size_t Depth = 0;
+
+        ~ReclamationSlot()
+        {
+            if (Index != NONE) ChunkReclamation.UnregisterThread(Index);
+        }
+    };
+
+    thread_local ReclamationSlot ChunkReclamationSlot;
+}
+
+World_ChunkReadGuard::World_ChunkReadGuard()
+{
+    if (ChunkReclamationSlot.Depth++ > 0) return;
+
+    if (ChunkReclamationSlot.Index == ReclamationSlot::NONE) ChunkReclamationSlot.Index = ChunkReclamation.RegisterThread();
+
+    ChunkReclamation.Enter(ChunkReclamationSlot.Index);
+}
+
+World_ChunkReadGuard::~World_ChunkReadGuard()
+{
+    assert(ChunkReclamationSlot.Depth > 0);
+
+    if (--ChunkReclamationSlot.Depth > 0) return;
+
+    ChunkReclamation.Leave(ChunkReclamationSlot.Index);
+}
+
+EpochReclamation& World_Chunk_GetReclamation()
+{
+    return ChunkReclamation;
+}
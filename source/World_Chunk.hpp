@@ -4,25 +4,147 @@
 #include <bitset>
 #include <memory>
 #include <array>
+#include <atomic>
 #include <vector>
+#include <optional>
 #include "World_Coordinate.hpp"
 #include "World_Block.hpp"
 #include "World_Light.hpp"
-#include "Graphics_Mesh.hpp"
 #include "Utility_Array2D.hpp"
 #include "Utility_Array3D.hpp"
+#include "Utility_PaletteArray.hpp"
+#include "Utility_EpochReclamation.hpp"
 
-using World_Chunk_BlockData  = Array3D<World_Block, World_CHUNK_X_SIZE, World_CHUNK_Y_SIZE, World_CHUNK_Z_SIZE, Array3DStoreOrder::YXZ>;
-using World_Chunk_LightData  = Array3D<World_Light, World_CHUNK_X_SIZE, World_CHUNK_Y_SIZE, World_CHUNK_Z_SIZE, Array3DStoreOrder::YXZ>;
-using World_Chunk_HeightData = Array2D<std::uint8_t, World_CHUNK_X_SIZE, World_CHUNK_Z_SIZE, Array2DStoreOrder::YX>;
+// Store order of block and light data, overridable at build time to compare layouts (see bench/Bench_StoreOrder.cpp).
+#ifndef NITROCRAFT_CHUNK_STORE_ORDER
+    #define NITROCRAFT_CHUNK_STORE_ORDER YXZ
+#endif
+
+constexpr Array3DStoreOrder World_CHUNK_STORE_ORDER = Array3DStoreOrder::NITROCRAFT_CHUNK_STORE_ORDER;
+
+using World_Chunk_SectionPaletteData = PaletteArray3D<World_Block, World_CHUNK_X_SIZE, World_CHUNK_SECTION_Y_SIZE, World_CHUNK_Z_SIZE, World_CHUNK_STORE_ORDER>;
+using World_Chunk_SectionLightData   = Array3D<World_Light, World_CHUNK_X_SIZE, World_CHUNK_SECTION_Y_SIZE, World_CHUNK_Z_SIZE, World_CHUNK_STORE_ORDER>;
+using World_Chunk_HeightData         = Array2D<std::uint8_t, World_CHUNK_X_SIZE, World_CHUNK_Z_SIZE, Array2DStoreOrder::YX>;
+
+// One bit per block of a section column: bit y of (x, z) is set when the block at (x, y, z) is opaque.
+using World_Chunk_SectionOpacityData = Array2D<std::uint16_t, World_CHUNK_X_SIZE, World_CHUNK_Z_SIZE, Array2DStoreOrder::YX>;
+
+static_assert(World_CHUNK_SECTION_Y_SIZE == 16, "World_Chunk_SectionOpacityData holds a section column in 16 bits");
+
+// Palette compressed blocks of a section, with their opacity kept alongside on every write.
+struct World_Chunk_SectionBlockData
+{
+    using FlatArray = World_Chunk_SectionPaletteData::FlatArray;
+
+    World_Chunk_SectionPaletteData Palette;
+    World_Chunk_SectionOpacityData Opacity;
+    bool                           HasTransparentBlocks = false; // Set once a non-air transparent block is stored.
+
+    World_Block At(std::size_t x, std::size_t y, std::size_t z) const { return Palette.At(x, y, z); }
+
+    void Set(std::size_t x, std::size_t y, std::size_t z, World_Block block);
+    void Fill(World_Block block);
+    void Decode(FlatArray& out) const { Palette.Decode(out); }
+    void Encode(const FlatArray& blocks);
+    void CopyFrom(const World_Chunk_SectionBlockData& other);
+
+    unsigned    GetBitsPerElement() const { return Palette.GetBitsPerElement(); }
+    std::size_t GetHeapUsage()      const { return Palette.GetHeapUsage(); }
+};
+
+// Decoded block data of a section, for bulk writes (generation) and bulk reads (lighting, meshing).
+using World_Chunk_FlatSectionBlockData = World_Chunk_SectionBlockData::FlatArray;
+
+// Decoded block data of a whole chunk.
+using World_Chunk_FlatBlockData = Array3D<World_Block, World_CHUNK_X_SIZE, World_CHUNK_Y_SIZE, World_CHUNK_Z_SIZE, World_CHUNK_STORE_ORDER>;
+
+// Decoded block data with a one block apron taken from the neighbours, for the mesher.
+// Local (x, y, z) is at (x + 1, y + 1, z + 1). Apron below and above the chunk is air.
+using World_Chunk_PaddedBlockData = Array3D<World_Block, World_CHUNK_X_SIZE + 2, World_CHUNK_Y_SIZE + 2, World_CHUNK_Z_SIZE + 2, World_CHUNK_STORE_ORDER>;
+
+// Whole chunk opacity columns with a one column apron taken from the neighbours, for the mesher.
+// Column (x, z) is at (x + 1, z + 1), bit y % 64 of word y / 64 is set when the block at y is opaque.
+using World_Chunk_OpacityColumn     = std::array<std::uint64_t, World_CHUNK_Y_SIZE / 64>;
+using World_Chunk_PaddedOpacityData = Array2D<World_Chunk_OpacityColumn, World_CHUNK_X_SIZE + 2, World_CHUNK_Z_SIZE + 2, Array2DStoreOrder::YX>;
 
 struct World_Chunk_Storage
 {
-    World_Chunk_BlockData  Blocks;
-    World_Chunk_LightData  Lights;
-    World_Chunk_HeightData Heights;
+    // Section i covers y in [i * World_CHUNK_SECTION_Y_SIZE, (i + 1) * World_CHUNK_SECTION_Y_SIZE).
+    // Block and light data of a section are sparse independently: while unallocated, every block (light) of the section
+    // holds UniformBlocks[i] (UniformLights[i]). They are allocated on the first write breaking uniformity and published
+    // atomically. Uniform values are only written by generation, allocated data lives as long as the storage.
+    std::array<std::atomic<World_Chunk_SectionBlockData*>, World_CHUNK_SECTION_COUNT> SectionBlocks{};
+    std::array<std::atomic<World_Chunk_SectionLightData*>, World_CHUNK_SECTION_COUNT> SectionLights{};
+    std::array<World_Block, World_CHUNK_SECTION_COUNT>                                UniformBlocks{};
+    std::array<World_Light, World_CHUNK_SECTION_COUNT>                                UniformLights{};
+    World_Chunk_HeightData                                                            Heights;
+
+    // Section data shared with snapshots (see World_ChunkSnapshot), immutable.
+    // While SectionBlocks[i] (SectionLights[i]) points to SharedBlocks[i] (SharedLights[i]), the first write clones it.
+    std::array<std::shared_ptr<const World_Chunk_SectionBlockData>, World_CHUNK_SECTION_COUNT> SharedBlocks{};
+    std::array<std::shared_ptr<const World_Chunk_SectionLightData>, World_CHUNK_SECTION_COUNT> SharedLights{};
+
+    World_Chunk_Storage() = default;
+    ~World_Chunk_Storage();
+
+    World_Chunk_Storage(const World_Chunk_Storage&) = delete;
+    World_Chunk_Storage& operator=(const World_Chunk_Storage&) = delete;
+
+    const World_Chunk_SectionBlockData* GetSectionBlocks(int section) const { return SectionBlocks[section].load(std::memory_order_acquire); }
+    const World_Chunk_SectionLightData* GetSectionLights(int section) const { return SectionLights[section].load(std::memory_order_acquire); }
+
+    World_Block GetBlockAt(World_LocalXYZ local) const;
+    World_Light GetLightAt(World_LocalXYZ local) const;
+
+    int  GetHeightAt(int local_x, int local_z) const { return Heights.At(local_x, local_z); }
+    int  GetMaxHeight() const;
+
+    // Block of a section if all of its blocks are the same, allocated or not.
+    std::optional<World_Block> GetSectionUniformBlock(int section) const;
+
+    // Light of a section if its lights are unallocated.
+    std::optional<World_Light> GetSectionUniformLight(int section) const;
+
+    // Opacity mask (see World_Chunk_SectionOpacityData) of a section column.
+    std::uint16_t GetSectionOpacity(int section, int local_x, int local_z) const;
+
+    // False if the section holds no non-air transparent block, i.e. every block not opaque is air.
+    bool SectionHasTransparentBlocks(int section) const;
+
+    // Opacity mask lookups, cheaper than GetBlockAt.
+    bool IsOpaqueAt(World_LocalXYZ local) const;
+    bool IsAirAt(World_LocalXYZ local) const;
+
+    void DecodeSectionBlocks(int section, World_Chunk_FlatSectionBlockData& out) const;
+    void DecodeBlocks(World_Chunk_FlatBlockData& out) const;
+
+    // Bytes of section data, including data shared with snapshots.
+    std::size_t GetSectionMemoryUsage() const;
+};
+
+// Storages and section data are recycled through lock-free pools (see World_Chunk.cpp).
+struct World_Chunk_StorageDeleter
+{
+    void operator()(World_Chunk_Storage* storage) const;
+};
+
+using World_Chunk_StoragePtr = std::unique_ptr<World_Chunk_Storage, World_Chunk_StorageDeleter>;
+
+// Returns a cleared storage.
+World_Chunk_StoragePtr World_Chunk_AllocateStorage();
+
+struct World_Chunk_PoolOccupancy
+{
+    std::size_t Used     = 0; // Objects in the pool's arena
+    std::size_t Capacity = 0;
+    std::size_t Overflow = 0; // Objects allocated from the heap as the arena was full
+    std::size_t Bytes    = 0; // Arena bytes touched so far
 };
 
+World_Chunk_PoolOccupancy World_Chunk_GetStoragePoolOccupancy();
+World_Chunk_PoolOccupancy World_Chunk_GetSectionBlockPoolOccupancy();
+World_Chunk_PoolOccupancy World_Chunk_GetSectionLightPoolOccupancy();
+
 enum class World_Chunk_Neighbour
 {
     XNZ0,
@@ -37,10 +159,78 @@ enum class World_Chunk_Neighbour
     COUNT,
 };
 
+constexpr World_Chunk_ID World_Chunk_NEIGHBOUR_OFFSETS[(std::size_t)World_Chunk_Neighbour::COUNT]
+{
+    World_Chunk_ID{ -1, 0,  0 }, // XNZ0
+    World_Chunk_ID{  1, 0,  0 }, // XPZ0
+    World_Chunk_ID{  0, 0, -1 }, // X0ZN
+    World_Chunk_ID{  0, 0,  1 }, // X0ZP
+    World_Chunk_ID{ -1, 0, -1 }, // XNZN
+    World_Chunk_ID{  1, 0, -1 }, // XPZN
+    World_Chunk_ID{ -1, 0,  1 }, // XNZP
+    World_Chunk_ID{  1, 0,  1 }, // XPZP
+};
+
+// Neighbour in the opposite direction, i.e. the direction back to this chunk from its neighbour.
+constexpr World_Chunk_Neighbour World_Chunk_OppositeNeighbour(World_Chunk_Neighbour neighbour)
+{
+    switch (neighbour)
+    {
+    case World_Chunk_Neighbour::XNZ0: return World_Chunk_Neighbour::XPZ0;
+    case World_Chunk_Neighbour::XPZ0: return World_Chunk_Neighbour::XNZ0;
+    case World_Chunk_Neighbour::X0ZN: return World_Chunk_Neighbour::X0ZP;
+    case World_Chunk_Neighbour::X0ZP: return World_Chunk_Neighbour::X0ZN;
+    case World_Chunk_Neighbour::XNZN: return World_Chunk_Neighbour::XPZP;
+    case World_Chunk_Neighbour::XPZN: return World_Chunk_Neighbour::XNZP;
+    case World_Chunk_Neighbour::XNZP: return World_Chunk_Neighbour::XPZN;
+    case World_Chunk_Neighbour::XPZP: return World_Chunk_Neighbour::XNZN;
+    default:                          return World_Chunk_Neighbour::COUNT;
+    }
+}
+
+// Storages of a chunk and its neighbours (indexed by World_Chunk_Neighbour), for reads crossing chunk borders.
+// Missing neighbours read as air with the minimum light.
+struct World_ChunkNeighbourhood
+{
+    const World_Chunk_Storage*                                                        Center = nullptr;
+    std::array<const World_Chunk_Storage*, (std::size_t)World_Chunk_Neighbour::COUNT> Neighbours{};
+
+    std::array<World_Block, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
+        GetCrossNeighbourBlocksAt(World_LocalXYZ local) const;
+    std::array<World_Light, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
+        GetCrossNeighbourLightsAt(World_LocalXYZ local) const;
+    std::array<World_Block, static_cast<std::size_t>(World_Block_WholeNeighbour::Count)>
+        GetWholeNeighbourBlocksAt(World_LocalXYZ local) const;
+
+    void DecodePaddedBlocks(World_Chunk_PaddedBlockData& out) const;
+    void DecodePaddedOpacity(World_Chunk_PaddedOpacityData& out) const;
+};
+
+// Immutable view of a chunk's storage at a given StorageVersion, read by meshers and raycasts without locks.
+// Its sections are shared with the chunk: writes to the chunk clone a shared section before modifying it.
+struct World_ChunkSnapshot
+{
+    std::uint32_t          Version = 0;
+    World_Chunk_StoragePtr Storage; // Every allocated section is shared (SectionBlocks[i] == SharedBlocks[i]).
+};
+
+using World_ChunkSnapshotPtr = std::shared_ptr<const World_ChunkSnapshot>;
+
+struct World_Chunk;
+
+// Snapshots of a chunk and its neighbours, held by a meshing job. Readable without a World_ChunkReadGuard.
+struct World_ChunkSnapshotView
+{
+    World_Chunk*                                                                  Chunk = nullptr;
+    World_ChunkSnapshotPtr                                                        Center;
+    std::array<World_ChunkSnapshotPtr, (std::size_t)World_Chunk_Neighbour::COUNT> Neighbours;
+    World_ChunkNeighbourhood                                                      Area;
+};
+
 enum class World_Chunk_Stage
 {
     // Stage==Empty: Initial stage of this chunk after allocation.
-    // All allocated chunks are guaranteed to be associated with neighbours (Chunk holds valid neighbour chunks' pointer).
+    // Chunks are scheduled only once their neighbours are associated (NeighboursSet==true).
     Empty,
 
     // Stage==Generating: Workers are generating terrains/caves for this chunk.
@@ -48,41 +238,114 @@ enum class World_Chunk_Stage
     GenerationComplete,
 
     // Stage==LocalLighting: Workers are flooding the chunk with initial lights.
-    // For LocalLighting to start, all chunk neighbours must be in Stage==GenerationComplete.
+    // Enqueued once this chunk and all the neighbours are in Stage>=GenerationComplete.
     LocalLightingInProgress,
     LocalLightingComplete,
 
-    // Stage==NeighbourLighting: This chunk is pending until all the neighbours become Stage==LocalLightingComplete.
+    // Stage==NeighbourLighting: Enqueued once this chunk and all the neighbours become Stage==LocalLightingComplete.
     // This stage ensures that lights from neighbour chunks are also propagated into this chunk.
     NeighbourLightingInProgress,
     NeighbourLightingComplete,
+
+    COUNT,
+};
+
+// Scheduling state of chunks, polled every frame by the main thread and written constantly by the workers.
+// Kept out of World_Chunk as a struct of arrays indexed by slot: scans read densely packed state, and writes never
+// share a cache line with the cold chunk payload (neighbour pointers, storage). Each array starts on its own cache line.
+struct World_ChunkStatePage
+{
+    static constexpr std::size_t SLOT_COUNT = 1024;
+
+    alignas(64) std::array<std::atomic<World_Chunk_Stage>, SLOT_COUNT> Stage;
+    alignas(64) std::array<std::atomic<std::uint8_t>,      SLOT_COUNT> EnqueuedStates;
+    alignas(64) std::array<std::atomic<bool>,              SLOT_COUNT> NeighboursSet;
+    alignas(64) std::array<std::atomic<bool>,              SLOT_COUNT> Retired;
+    alignas(64) std::array<std::atomic<std::uint16_t>,     SLOT_COUNT> PendingGenerations;
+    alignas(64) std::array<std::atomic<std::uint16_t>,     SLOT_COUNT> PendingLocalLightings;
+    alignas(64) std::array<std::atomic<std::uint32_t>,     SLOT_COUNT> StorageVersion;
+    alignas(64) std::array<std::atomic<std::uint32_t>,     SLOT_COUNT> PinCount;
 };
 
+struct World_ChunkStateSlot
+{
+    World_ChunkStatePage* Page  = nullptr;
+    std::uint32_t         Index = 0;
+};
+
+// Slots are handed out on chunk construction with their state reset, and taken back on destruction.
+// Pages are allocated on demand and never freed.
+World_ChunkStateSlot World_Chunk_AllocateStateSlot();
+void                 World_Chunk_ReleaseStateSlot(World_ChunkStateSlot slot);
+
 struct World_Chunk
 {
     const World_Chunk_ID ID;
 
-    std::atomic<World_Chunk_Stage> Stage = World_Chunk_Stage::Empty;
+    const World_ChunkStateSlot StateSlot;
 
-    // Job deduplicate bitmask (GEN=1, LOCAL_LIGHT=2, NEIGHBOUR_LIGHT=4, MESH=8).
+    // Scheduling state, stored in StateSlot (see World_ChunkStatePage). Atomics, writable through const chunks.
+    //
+    // Stage: pipeline stage of the chunk.
+    //
+    // EnqueuedStates: job deduplicate bitmask (GEN=1, LOCAL_LIGHT=2, NEIGHBOUR_LIGHT=4, MESH=8).
     // Stores the job type the chunk is currently queued for.
     // Example, when the chunk is in queue for JobType::Generation, EnqueuedStates |= GEN.
     // Example, when the chunk is poped out of queue for JobType::Generation, EnqueuedStates &= ~GEN.
     // This is to avoid duplicate enqueuing of jobs of same type.
-    std::atomic<std::uint8_t> EnqueuedStates = 0;
+    // The same bits shifted left by 4 mark job types cancelled since their last enqueue, for telemetry.
+    //
+    // NeighboursSet: becomes true once all Neighbours are assigned.
+    //
+    // PendingGenerations, PendingLocalLightings: dependency masks of the chunk pipeline (see World_ChunkManager::ArmDependencies).
+    // Bit i < 8 is set while Neighbours[i] hasn't reached the prerequisite stage, bit 8 stands for this chunk itself.
+    // Bit 15 is set once the dependent stage has been requested.
+    // LocalLighting waits for Generation of the 3x3 chunks, NeighbourLighting waits for LocalLighting of the 3x3 chunks.
+    //
+    // StorageVersion: bumped when the chunk content changes, after publishing the snapshot of the new version.
+    //
+    // PinCount, Retired: unloading state (see World_ChunkManager::UnloadChunks_MainThread).
+    // PinCount counts queued chunk jobs and meshing requests holding this chunk, pinned chunks are never freed.
+    // Retired is set while the chunk is unlinked from the chunk map and waiting to be freed.
+    std::atomic<World_Chunk_Stage>& Stage()                 const { return StateSlot.Page->Stage[StateSlot.Index]; }
+    std::atomic<std::uint8_t>&      EnqueuedStates()        const { return StateSlot.Page->EnqueuedStates[StateSlot.Index]; }
+    std::atomic<bool>&              NeighboursSet()         const { return StateSlot.Page->NeighboursSet[StateSlot.Index]; }
+    std::atomic<std::uint16_t>&     PendingGenerations()    const { return StateSlot.Page->PendingGenerations[StateSlot.Index]; }
+    std::atomic<std::uint16_t>&     PendingLocalLightings() const { return StateSlot.Page->PendingLocalLightings[StateSlot.Index]; }
+    std::atomic<std::uint32_t>&     StorageVersion()        const { return StateSlot.Page->StorageVersion[StateSlot.Index]; }
+    std::atomic<std::uint32_t>&     PinCount()              const { return StateSlot.Page->PinCount[StateSlot.Index]; }
+    std::atomic<bool>&              Retired()               const { return StateSlot.Page->Retired[StateSlot.Index]; }
 
     bool HasModified = false;
 
-    std::array<World_Chunk*, (std::size_t)World_Chunk_Neighbour::COUNT> Neighbours{};
-    std::atomic<bool> NeighboursSet = false;
+    // Assigned by the main thread. Chunks of the loading area's outermost ring only have their in-area neighbours assigned.
+    std::array<std::atomic<World_Chunk*>, (std::size_t)World_Chunk_Neighbour::COUNT> Neighbours{};
 
-    std::unique_ptr<World_Chunk_Storage> Storage;
-    std::atomic<std::uint32_t>           StorageVersion = 0;
+    World_Chunk_StoragePtr Storage;
 
-    explicit World_Chunk(World_Chunk_ID id) : ID{ id } {}
+    // Latest published snapshot of Storage, null until the first one.
+    std::atomic<World_ChunkSnapshotPtr> Snapshot;
 
-    World_Block GetBlockAt(World_LocalXYZ local) const;
-    World_Light GetLightAt(World_LocalXYZ local) const;
+    // GetMemoryUsage as of the last UpdateMemoryUsage, readable while jobs write the chunk.
+    std::atomic<std::size_t> MemoryUsage = 0;
+
+    // Manager's center update tick this chunk was last within the loading area, main thread only.
+    std::uint64_t LastRequiredTick = 0;
+
+    // Time (Time_GetTime) this chunk was first requested while in the inner ring of the render area. 0 if not tracked.
+    std::atomic<double> RenderRequestTime = 0.0;
+
+    // Time (Time_GetTime) the queued job of each type was enqueued, indexed by World_ChunkManager::JobType.
+    std::array<std::atomic<double>, 3> JobEnqueueTimes{};
+
+    explicit World_Chunk(World_Chunk_ID id) : ID{ id }, StateSlot{ World_Chunk_AllocateStateSlot() } {}
+    ~World_Chunk() { World_Chunk_ReleaseStateSlot(StateSlot); }
+
+    World_Chunk(const World_Chunk&) = delete;
+    World_Chunk& operator=(const World_Chunk&) = delete;
+
+    World_Block GetBlockAt(World_LocalXYZ local) const { return Storage->GetBlockAt(local); }
+    World_Light GetLightAt(World_LocalXYZ local) const { return Storage->GetLightAt(local); }
     World_Light GetSunlightAt(World_LocalXYZ local) const;
     World_Light GetPointlightAt(World_LocalXYZ local) const;
 
@@ -91,13 +354,73 @@ struct World_Chunk
     void SetSunlightAt(World_LocalXYZ local, World_Light sunlight);
     void SetPointlightAt(World_LocalXYZ local, World_Light pointlight);
 
-    int  GetHeightAt(int local_x, int local_z) const;
-    int  GetMaxHeight() const;
+    int  GetHeightAt(int local_x, int local_z) const { return Storage->GetHeightAt(local_x, local_z); }
+    int  GetMaxHeight() const { return Storage->GetMaxHeight(); }
+
+    // Live storages of this chunk and its neighbours. Requires NeighboursSet.
+    World_ChunkNeighbourhood GetNeighbourhood() const;
 
     std::array<World_Block, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
-        GetCrossNeighbourBlocksAt(World_LocalXYZ local) const;
+        GetCrossNeighbourBlocksAt(World_LocalXYZ local) const { return GetNeighbourhood().GetCrossNeighbourBlocksAt(local); }
     std::array<World_Light, static_cast<std::size_t>(World_Block_CrossNeighbour::Count)>
-        GetCrossNeighbourLightsAt(World_LocalXYZ local) const;
+        GetCrossNeighbourLightsAt(World_LocalXYZ local) const { return GetNeighbourhood().GetCrossNeighbourLightsAt(local); }
     std::array<World_Block, static_cast<std::size_t>(World_Block_WholeNeighbour::Count)>
-        GetWholeNeighbourBlocksAt(World_LocalXYZ local) const;
+        GetWholeNeighbourBlocksAt(World_LocalXYZ local) const { return GetNeighbourhood().GetWholeNeighbourBlocksAt(local); }
+
+    // See World_Chunk_Storage.
+    std::optional<World_Block> GetSectionUniformBlock(int section) const { return Storage->GetSectionUniformBlock(section); }
+    std::optional<World_Light> GetSectionUniformLight(int section) const { return Storage->GetSectionUniformLight(section); }
+    std::uint16_t GetSectionOpacity(int section, int local_x, int local_z) const { return Storage->GetSectionOpacity(section, local_x, local_z); }
+    bool SectionHasTransparentBlocks(int section) const { return Storage->SectionHasTransparentBlocks(section); }
+    bool IsOpaqueAt(World_LocalXYZ local) const { return Storage->IsOpaqueAt(local); }
+    bool IsAirAt(World_LocalXYZ local) const { return Storage->IsAirAt(local); }
+
+    // Generation only: stores a section's blocks, leaving it unallocated when uniform.
+    // light is the initial light of the whole section.
+    void EncodeSectionBlocks(int section, const World_Chunk_FlatSectionBlockData& blocks, World_Light light);
+
+    // Bulk decode. The padded variants require NeighboursSet.
+    void DecodeSectionBlocks(int section, World_Chunk_FlatSectionBlockData& out) const { Storage->DecodeSectionBlocks(section, out); }
+    void DecodeBlocks(World_Chunk_FlatBlockData& out) const { Storage->DecodeBlocks(out); }
+    void DecodePaddedBlocks(World_Chunk_PaddedBlockData& out) const { GetNeighbourhood().DecodePaddedBlocks(out); }
+    void DecodePaddedOpacity(World_Chunk_PaddedOpacityData& out) const { GetNeighbourhood().DecodePaddedOpacity(out); }
+
+    // Reads the storage and the snapshot: from the thread writing the chunk, or while nothing does.
+    std::size_t GetMemoryUsage() const;
+
+    // Called by the thread writing the chunk once it is done.
+    void UpdateMemoryUsage() { MemoryUsage.store(GetMemoryUsage(), std::memory_order_relaxed); }
+
+    // Publishes the current storage as the snapshot of the given version, handing the sections written since the last
+    // snapshot over without copying. No other thread may access the chunk's storage meanwhile, lighting of the
+    // neighbours included: sections replaced since the last snapshot are dropped.
+    void PublishSnapshot(std::uint32_t version);
+
+    // This chunk and its neighbours completed neighbour lighting: the snapshots a mesh of this chunk reads are published.
+    // From the main thread, or within a World_ChunkReadGuard. False unless NeighboursSet.
+    bool IsNeighbourhoodLit() const;
+
+    // Within a World_ChunkReadGuard, requires NeighboursSet. Empty if this chunk has no snapshot yet.
+    // Neighbours without a snapshot read as missing.
+    std::optional<World_ChunkSnapshotView> TakeSnapshotView();
 };
+
+// Same order as World_Chunk::GetWholeNeighbourBlocksAt, read from decoded blocks.
+std::array<World_Block, static_cast<std::size_t>(World_Block_WholeNeighbour::Count)>
+    World_Chunk_GetWholeNeighbourBlocksAt(const World_Chunk_PaddedBlockData& blocks, World_LocalXYZ local);
+
+// Scope of a non-main thread reading chunks reached through neighbour pointers.
+// Unloaded chunks are unlinked first and only freed once every guard that could have reached them has ended.
+// Readers must check NeighboursSet within the guard before following neighbour pointers.
+// Guards nest: an inner guard on the same thread keeps the outer one's epoch, the outermost guard ends the scope.
+class World_ChunkReadGuard
+{
+public:
+    World_ChunkReadGuard();
+    ~World_ChunkReadGuard();
+
+    World_ChunkReadGuard(const World_ChunkReadGuard&) = delete;
+    World_ChunkReadGuard& operator=(const World_ChunkReadGuard&) = delete;
+};
+
+EpochReclamation& World_Chunk_GetReclamation();
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include "World_Coordinate.hpp"
+#include "World_Chunk.hpp"
+
+// Toroidal grid of chunk pointers, indexed by chunk ID modulo the grid diameter along x and z.
+// Chunks less than Diameter apart along both axes never share a slot: a loading area up to Diameter wide fits without
+// collisions, and moving its center only overwrites the slots of the chunks leaving it.
+// A slot may still hold a chunk that left the loading area, Find checks the ID.
+// Written by the main thread only. Reads are lock-free, from the main thread or within a World_ChunkReadGuard:
+// slots are cleared before their chunk is retired (see World_ChunkManager::UnloadChunks_MainThread).
+class World_ChunkGrid
+{
+public:
+    explicit World_ChunkGrid(int diameter)
+        : m_Diameter{ diameter }
+        , m_Slots{ std::make_unique<std::atomic<World_Chunk*>[]>(static_cast<std::size_t>(diameter) * static_cast<std::size_t>(diameter)) }
+    {}
+
+    World_ChunkGrid(const World_ChunkGrid&) = delete;
+    World_ChunkGrid& operator=(const World_ChunkGrid&) = delete;
+
+    int GetDiameter() const { return m_Diameter; }
+
+    World_Chunk* Find(World_Chunk_ID id) const
+    {
+        World_Chunk* chunk = SlotOf(id).load(std::memory_order_acquire);
+
+        return (chunk != nullptr && chunk->ID == id) ? chunk : nullptr;
+    }
+
+    void Assign_MainThread(World_Chunk* chunk)
+    {
+        SlotOf(chunk->ID).store(chunk, std::memory_order_release);
+    }
+
+    // Leaves the slot alone if it was already reused by another chunk.
+    void Clear_MainThread(const World_Chunk* chunk)
+    {
+        auto& slot = SlotOf(chunk->ID);
+
+        if (slot.load(std::memory_order_relaxed) == chunk) slot.store(nullptr, std::memory_order_release);
+    }
+
+private:
+    int                                          m_Diameter;
+    std::unique_ptr<std::atomic<World_Chunk*>[]> m_Slots;
+
+    std::atomic<World_Chunk*>& SlotOf(World_Chunk_ID id) const
+    {
+        const int x = ((id.x % m_Diameter) + m_Diameter) % m_Diameter;
+        const int z = ((id.z % m_Diameter) + m_Diameter) % m_Diameter;
+
+        return m_Slots[static_cast<std::size_t>(x) * static_cast<std::size_t>(m_Diameter) + static_cast<std::size_t>(z)];
+    }
+};
@@ -1,144 +1,358 @@
 #include "World_ChunkManager.hpp"
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
 #include "World_Generation.hpp"
 #include "World_Light.hpp"
+#include "Utility_Time.hpp"
 
-World_ChunkManager::World_ChunkManager()
+namespace
 {
-    m_ChunkMap.reserve(GetLoadingDiameter() * GetLoadingDiameter() * 8);
+    // Chunks inside the view cone are prioritized as if they were half as far away.
+    constexpr float VIEW_CONE_PRIORITY_SCALE = 0.25f;
+
+    // Re-prioritize queued jobs when the view direction turns more than ~15 degrees.
+    constexpr float VIEW_REPRIORITIZE_COS_THRESHOLD = 0.966f;
+
+    // Orders jobs of the same chunk: Generation before LocalLighting before NeighbourLighting.
+    constexpr float JOB_TYPE_PRIORITY_BIAS = 0.01f;
+
+    // Heap comparator turning std::*_heap into a min-heap on Priority.
+    constexpr auto JobHeapCompare = [](const auto& a, const auto& b) { return a.Priority > b.Priority; };
 
-    m_WorkerCount = std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2 - 1, 1u, 4u);
+    // Index of the worker running on this thread, NO_WORKER on non-worker threads.
+    constexpr std::size_t NO_WORKER = static_cast<std::size_t>(-1);
+
+    thread_local std::size_t CurrentWorkerIndex = NO_WORKER;
+
+    // Rounds towards negative infinity, for aligning chunk IDs to regions.
+    constexpr int FloorDiv(int a, int b)
+    {
+        return (a >= 0 ? a : a - b + 1) / b;
+    }
 
-    m_Workers.reserve(m_WorkerCount);
-    
-    for (std::size_t i = 0u; i < m_WorkerCount; ++i)
+    // Calls f(id) for every chunk within distance_a of center_a and not within distance_b of center_b.
+    // Only the difference is visited, column by column. A negative distance stands for an empty area.
+    template<typename F>
+    void ForEachInAreaDifference(World_Chunk_ID center_a, int distance_a, World_Chunk_ID center_b, int distance_b, F&& f)
     {
-        m_Workers.emplace_back([this] { World_Generation_Initialize(12345); JobLoop(); });
+        if (distance_a < 0) return;
+
+        const int z_begin = center_a.z - distance_a;
+        const int z_end   = center_a.z + distance_a;
+
+        for (int x = center_a.x - distance_a; x <= center_a.x + distance_a; ++x)
+        {
+            if (distance_b < 0 || std::abs(x - center_b.x) > distance_b)
+            {
+                for (int z = z_begin; z <= z_end; ++z) f(World_Chunk_ID{ x, 0, z });
+                continue;
+            }
+
+            for (int z = z_begin; z <= std::min(z_end, center_b.z - distance_b - 1); ++z) f(World_Chunk_ID{ x, 0, z });
+            for (int z = std::max(z_begin, center_b.z + distance_b + 1); z <= z_end; ++z) f(World_Chunk_ID{ x, 0, z });
+        }
     }
+
+    // Last snapshot looked up by this thread (see World_ChunkManager::GetChunkSnapshotAt).
+    // Version points into the chunk's state page, which outlives the chunk.
+    struct SnapshotLookupCache
+    {
+        const World_ChunkManager*         Manager = nullptr;
+        World_Chunk_ID                    ID{ 0, 0, 0 };
+        std::uint64_t                     RetireCount = 0;
+        const std::atomic<std::uint32_t>* Version = nullptr;
+        World_ChunkSnapshotPtr            Snapshot;
+    };
+
+    thread_local SnapshotLookupCache LastSnapshotLookup;
 }
 
-World_ChunkManager::~World_ChunkManager()
+World_ChunkManager::World_ChunkManager(TaskScheduler& scheduler)
+    : m_Scheduler{ scheduler }
 {
-    m_JobRetire.store(true, std::memory_order_release);
+    m_ChunkMap.reserve(GetLoadingDiameter() * GetLoadingDiameter() * 8);
+
+    const std::size_t worker_count = m_Scheduler.GetWorkerCount();
+
+    m_WorkerDeques.reserve(worker_count);
 
-    m_JobQueueCond.notify_all();
+    for (std::size_t i = 0u; i < worker_count; ++i)
+    {
+        m_WorkerDeques.push_back(std::make_unique<WorkStealingDeque<PackedJob>>());
+    }
 
-    m_Workers.clear();
+    m_WorkerCancelWindows.resize(worker_count, m_CancelWindow);
+
+    m_Scheduler.Register(TaskType::Chunk, *this);
 }
 
-void World_ChunkManager::SetCenterChunk_MainThread(World_Chunk_ID center_id)
+World_ChunkManager::~World_ChunkManager()
 {
-    static std::size_t prev_render_distance = m_RenderDistance;
+    // Jobs still queued are dropped along with their chunks.
+    m_Scheduler.Unregister(TaskType::Chunk);
+}
 
-    if (m_CurrentChunkID == center_id && prev_render_distance == m_RenderDistance) return;
+void World_ChunkManager::SetCenterChunk_MainThread(World_Chunk_ID center_id, glm::vec3 view_direction, float view_half_angle)
+{
+    ReclaimChunks_MainThread();
 
-    m_CurrentChunkID = center_id;
-    prev_render_distance = m_RenderDistance;
+    // Flatten the view direction, chunk columns span the whole world height.
+    glm::vec3 flat_view_direction{ view_direction.x, 0.0f, view_direction.z };
+    const float flat_length = glm::length(flat_view_direction);
+    flat_view_direction = (flat_length > 1e-4f) ? flat_view_direction / flat_length : glm::vec3(0.0f, 0.0f, -1.0f);
 
-    // Update chunk map.
-    // Loaded area's outermost ring's chunks are NOT neighbour set.
     const int loading_distance = static_cast<int>(GetLoadingDistance());
-    const int loading_diameter = static_cast<int>(GetLoadingDiameter());
+    const int render_distance  = static_cast<int>(m_RenderDistance);
 
-    std::vector<World_Chunk*> loading_area(loading_diameter * loading_diameter, nullptr);
+    if (m_CurrentChunkID == center_id && m_AreaRenderDistance == render_distance)
+    {
+        // Center unchanged, only re-prioritize if the view turned considerably.
+        std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+
+        if (glm::dot(m_PriorityViewDirection, flat_view_direction) < VIEW_REPRIORITIZE_COS_THRESHOLD)
+        {
+            m_PriorityViewDirection    = flat_view_direction;
+            m_PriorityViewCosHalfAngle = std::cos(view_half_angle);
+
+            ReprioritizeJobs_ThreadUnsafe();
+        }
+
+        return;
+    }
+
+    // Areas of the previous update. Only chunks entering or leaving the areas are processed: strips along the edges for a
+    // move of a chunk or two, everything after a teleport or on the first update.
+    const World_Chunk_ID previous_center           = m_CurrentChunkID;
+    const int            previous_loading_distance = m_AreaRenderDistance < 0 ? -1 : m_AreaRenderDistance + static_cast<int>(LOADING_MARGIN);
+    const int            previous_render_distance  = m_AreaRenderDistance;
 
-    auto index_of = [loading_diameter](int i, int j) { return i * loading_diameter + j; };
+    m_CurrentChunkID     = center_id;
+    m_AreaRenderDistance = render_distance;
+
+    m_CenterTick++;
+
+    // Chunks leaving the loading area were last required on the previous tick, LRU order for unloading.
+    ForEachInAreaDifference(previous_center, previous_loading_distance, m_CurrentChunkID, loading_distance, [this](World_Chunk_ID id)
+    {
+        if (World_Chunk* chunk = m_ChunkGrid.Find(id)) chunk->LastRequiredTick = m_CenterTick - 1;
+    });
+
+    // Update chunk map with the chunks entering the loading area.
+    std::vector<World_Chunk*> entering;
 
-    // Chunks that are not in loaded area are allocated in ChunkMap.
     {
         std::lock_guard<std::mutex> lock{ m_ChunkMapMutex };
 
-        for (int ix = m_CurrentChunkID.x - loading_distance, ax = 0; ix <= m_CurrentChunkID.x + loading_distance; ++ix, ++ax)
+        ForEachInAreaDifference(m_CurrentChunkID, loading_distance, previous_center, previous_loading_distance, [&](World_Chunk_ID id)
         {
-            for (int iz = m_CurrentChunkID.z - loading_distance, az = 0; iz <= m_CurrentChunkID.z + loading_distance; ++iz, ++az)
+            World_Chunk* chunk = m_ChunkGrid.Find(id);
+
+            if (chunk == nullptr)
             {
-                World_Chunk_ID id{ ix, 0, iz };
+                if (auto iter = m_ChunkMap.find(id); iter != m_ChunkMap.end())
+                {
+                    chunk = iter->second.get();
+                }
+                else if (auto retired = m_RetiredChunks.find(id); retired != m_RetiredChunks.end())
+                {
+                    // Required again before being detached, neighbour pointers are still intact.
+                    chunk = retired->second.Chunk.get();
 
-                auto& slot = loading_area[index_of(ax, az)];
+                    chunk->Retired().store(false, std::memory_order_seq_cst);
 
-                if (auto iter = m_ChunkMap.find(id); iter == m_ChunkMap.end())
+                    m_ChunkMap.emplace(id, std::move(retired->second.Chunk));
+                    m_RetiredChunks.erase(retired);
+                }
+                else
                 {
                     auto new_chunk = std::make_unique<World_Chunk>(id);
 
-                    new_chunk->Storage = std::make_unique<World_Chunk_Storage>();
+                    new_chunk->Storage = World_Chunk_AllocateStorage();
+                    new_chunk->UpdateMemoryUsage();
 
-                    slot = new_chunk.get();
+                    chunk = new_chunk.get();
 
                     m_ChunkMap.emplace(id, std::move(new_chunk));
                 }
-                else
-                {
-                    slot = iter->second.get();
-                }
+
+                m_ChunkGrid.Assign_MainThread(chunk);
             }
-        }
+
+            chunk->LastRequiredTick = m_CenterTick;
+
+            entering.push_back(chunk);
+        });
     }
 
-    // Associate neighbours for non-outermost ring chunks.
-    for (int i = 1; i < loading_diameter - 1; ++i)
+    // Associate neighbours of the entering chunks and of the chunks next to them, the only ones gaining neighbours.
+    // Every in-area neighbour is assigned, so chunks of the outermost ring can still reach their dependents through
+    // their neighbour pointers. Loaded area's outermost ring's chunks are NOT neighbour set.
+    auto in_loading_area = [this, loading_distance](World_Chunk_ID id)
+    {
+        return std::abs(id.x - m_CurrentChunkID.x) <= loading_distance && std::abs(id.z - m_CurrentChunkID.z) <= loading_distance;
+    };
+
+    auto associate_neighbours = [&](World_Chunk* c)
     {
-        for (int j = 1; j < loading_diameter - 1; ++j)
+        if (c->NeighboursSet().load(std::memory_order_relaxed)) return;
+
+        bool all_set = true;
+
+        for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
         {
-            auto c = loading_area[index_of(i,j)];
+            const World_Chunk_ID neighbour_id = c->ID + World_Chunk_NEIGHBOUR_OFFSETS[n];
+
+            if (!in_loading_area(neighbour_id))
+            {
+                all_set = false;
+                continue;
+            }
+
+            if (c->Neighbours[n].load(std::memory_order_relaxed) == nullptr)
+            {
+                c->Neighbours[n].store(m_ChunkGrid.Find(neighbour_id), std::memory_order_seq_cst);
+            }
+        }
 
-            if (c->NeighboursSet.load(std::memory_order_relaxed)) continue;
+        if (all_set) c->NeighboursSet().store(true, std::memory_order_release);
+    };
 
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::XNZ0] = loading_area[index_of(i - 1, j    )];
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::XPZ0] = loading_area[index_of(i + 1, j    )];
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZN] = loading_area[index_of(i    , j - 1)];
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::X0ZP] = loading_area[index_of(i    , j + 1)];
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::XNZN] = loading_area[index_of(i - 1, j - 1)];
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::XPZN] = loading_area[index_of(i + 1, j - 1)];
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::XNZP] = loading_area[index_of(i - 1, j + 1)];
-            c->Neighbours[(std::size_t)World_Chunk_Neighbour::XPZP] = loading_area[index_of(i + 1, j + 1)];
+    for (World_Chunk* c : entering)
+    {
+        associate_neighbours(c);
 
-            c->NeighboursSet.store(true, std::memory_order_release);
+        for (const auto& offset : World_Chunk_NEIGHBOUR_OFFSETS)
+        {
+            if (!in_loading_area(c->ID + offset)) continue;
+
+            associate_neighbours(m_ChunkGrid.Find(c->ID + offset));
         }
     }
 
-    // Schedule work for render area.
-    // Render area is an area within ring3 excluding three-outermost-ring area.
+    // Schedule work for render area and the ring around it, whose snapshots the render area's meshes read.
+    // Neighbour lighting is requested within ring1 of the render area, local lighting within ring2, generation within ring3.
+    // The loading area's outermost ring (ring4) is never generated.
     {
+        const double now = Time_GetTime();
+
         std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
 
-        for (int i = 3; i < loading_diameter - 3; ++i)
-        for (int j = 3; j < loading_diameter - 3; ++j)
+        // Jobs of chunks that left the loading area are cancelled, queued ones are swept right away.
+        // The epoch is published before any job is requested, see IsJobCancelled.
+        m_CancelWindow.CenterID = m_CurrentChunkID;
+        m_CancelWindow.Distance = loading_distance;
+        m_CancelWindow.Epoch    = m_CancelEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+        SweepCancelledJobs_ThreadUnsafe();
+
+        // Queued jobs were prioritized against the previous center.
+        m_PriorityCenterID         = m_CurrentChunkID;
+        m_PriorityViewDirection    = flat_view_direction;
+        m_PriorityViewCosHalfAngle = std::cos(view_half_angle);
+
+        ReprioritizeJobs_ThreadUnsafe();
+
+        auto request = [&](World_Chunk_ID id)
         {
-            World_Chunk* c = loading_area[index_of(i, j)];
-            if (c->Stage.load(std::memory_order_acquire) < World_Chunk_Stage::NeighbourLightingInProgress)
-                EnqueueDedupJob_ThreadUnsafe({ c, JobType::NeighbourLighting });
-        }
+            World_Chunk* c = m_ChunkGrid.Find(id);
+
+            if (c->Stage().load(std::memory_order_acquire) >= World_Chunk_Stage::NeighbourLightingInProgress) return;
+
+            const int ring = std::max(std::abs(id.x - m_CurrentChunkID.x), std::abs(id.z - m_CurrentChunkID.z));
+
+            if (ring <= INNER_RING_DISTANCE)
+            {
+                double expected = 0.0;
+                c->RenderRequestTime.compare_exchange_strong(expected, now, std::memory_order_relaxed);
+            }
+
+            RequestNeighbourLighting_ThreadUnsafe(c);
+        };
+
+        // Chunks entering the lit area. Chunks already in it stay requested: their dependencies lie within the
+        // loading area, whose jobs are never cancelled.
+        const int lit_distance          = render_distance + 1;
+        const int previous_lit_distance = previous_render_distance < 0 ? -1 : previous_render_distance + 1;
+
+        ForEachInAreaDifference(m_CurrentChunkID, lit_distance, previous_center, previous_lit_distance, request);
+
+        // The inner ring is requested again on every move, for its time to renderable and any ready job to re-enqueue.
+        ForEachInAreaDifference(m_CurrentChunkID, INNER_RING_DISTANCE, previous_center, -1, request);
     }
 
-    m_JobQueueCond.notify_one();
+    m_Scheduler.NotifyAll();
+
+    UnloadChunks_MainThread();
 }
 
 std::vector<World_Chunk*> World_ChunkManager::GetChunksInRenderArea_MainThread() const
 {
     std::vector<World_Chunk*> chunks_to_render;
 
+    // Render area lies within the loading area, all in the grid.
+    for (int ix = m_CurrentChunkID.x - static_cast<int>(m_RenderDistance); ix <= m_CurrentChunkID.x + static_cast<int>(m_RenderDistance); ++ix)
+    for (int iz = m_CurrentChunkID.z - static_cast<int>(m_RenderDistance); iz <= m_CurrentChunkID.z + static_cast<int>(m_RenderDistance); ++iz)
     {
-        std::lock_guard<std::mutex> lock{ m_ChunkMapMutex };
-
-        for (int ix = m_CurrentChunkID.x - static_cast<int>(m_RenderDistance); ix <= m_CurrentChunkID.x + static_cast<int>(m_RenderDistance); ++ix)
-        for (int iz = m_CurrentChunkID.z - static_cast<int>(m_RenderDistance); iz <= m_CurrentChunkID.z + static_cast<int>(m_RenderDistance); ++iz)
-        {
-            if (auto iter = m_ChunkMap.find(World_Chunk_ID(ix, 0, iz)); iter != m_ChunkMap.end())
-            {
-                chunks_to_render.push_back(iter->second.get());
-            }
-        }
+        if (World_Chunk* chunk = m_ChunkGrid.Find(World_Chunk_ID(ix, 0, iz))) chunks_to_render.push_back(chunk);
     }
 
     return chunks_to_render;
 }
 
+std::size_t World_ChunkManager::GetQueuedJobCount() const
+{
+    std::size_t count = m_JobQueueSize.load(std::memory_order_relaxed);
+
+    for (const auto& deque : m_WorkerDeques) count += deque->Size();
+
+    return count;
+}
+
+std::array<std::size_t, (std::size_t)World_Chunk_Stage::COUNT> World_ChunkManager::GetChunkStageCounts() const
+{
+    std::array<std::size_t, (std::size_t)World_Chunk_Stage::COUNT> counts{};
+
+    std::lock_guard<std::mutex> lock{ m_ChunkMapMutex };
+
+    for (const auto& [id, chunk] : m_ChunkMap) counts[static_cast<std::size_t>(chunk->Stage().load(std::memory_order_relaxed))]++;
+
+    return counts;
+}
+
+World_ChunkManager::LatencyPercentiles World_ChunkManager::GetInnerRingTimeToRenderable() const
+{
+    std::vector<double> samples;
+
+    {
+        std::lock_guard<std::mutex> lock{ m_TimeToRenderableMutex };
+
+        samples = m_TimeToRenderableSamples;
+    }
+
+    if (samples.empty()) return {};
+
+    auto percentile = [&samples](double p)
+    {
+        auto nth = samples.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), nth, samples.end());
+        return *nth;
+    };
+
+    return LatencyPercentiles{ percentile(0.5), percentile(0.99), samples.size() };
+}
+
 std::optional<const World_Chunk*> World_ChunkManager::GetChunkAt(World_GlobalXYZ global) const
 {
+    const World_Chunk_ID id = World_FromGlobalToChunkID(global);
+
+    if (const World_Chunk* chunk = m_ChunkGrid.Find(id)) return chunk;
+
     std::lock_guard<std::mutex> lock{ m_ChunkMapMutex };
 
-    if (auto iter = m_ChunkMap.find(World_FromGlobalToChunkID(global)); iter != m_ChunkMap.end())
+    if (auto iter = m_ChunkMap.find(id); iter != m_ChunkMap.end())
     {
         return iter->second.get();
     }
@@ -148,203 +362,762 @@ std::optional<const World_Chunk*> World_ChunkManager::GetChunkAt(World_GlobalXYZ
     }
 }
 
+const World_ChunkSnapshot* World_ChunkManager::GetChunkSnapshotAt(World_GlobalXYZ global) const
+{
+    const World_Chunk_ID id = World_FromGlobalToChunkID(global);
+
+    auto& cache = LastSnapshotLookup;
+
+    const std::uint64_t retire_count = m_ChunkRetireCount.load(std::memory_order_acquire);
+
+    // Snapshots are published before their version, an unchanged version means the cached snapshot is the latest.
+    if (cache.Manager == this && cache.ID == id && cache.RetireCount == retire_count &&
+        cache.Version->load(std::memory_order_acquire) == cache.Snapshot->Version)
+    {
+        return cache.Snapshot.get();
+    }
+
+    World_ChunkReadGuard guard;
+
+    auto chunk = GetChunkAt(global);
+
+    World_ChunkSnapshotPtr snapshot = chunk ? chunk.value()->Snapshot.load(std::memory_order_acquire) : nullptr;
+
+    if (!snapshot)
+    {
+        cache = SnapshotLookupCache{};
+        return nullptr;
+    }
+
+    cache = SnapshotLookupCache{ this, id, retire_count, &chunk.value()->StorageVersion(), std::move(snapshot) };
+
+    return cache.Snapshot.get();
+}
+
+std::vector<World_Chunk_ID> World_ChunkManager::TakeUnloadedChunkIDs_MainThread()
+{
+    return std::exchange(m_UnloadedChunkIDs, {});
+}
+
 void World_ChunkManager::SetRenderDistance(std::size_t render_distance)
 {
-    m_RenderDistance = std::clamp<std::size_t>(render_distance, 2, 32);
+    m_RenderDistance = std::clamp<std::size_t>(render_distance, 2, MAX_RENDER_DISTANCE);
 }
 
-std::size_t World_ChunkManager::GetLoadingDistance() const
+void World_ChunkManager::SetUnloadDistance(std::size_t unload_distance)
 {
-    return m_RenderDistance + 3;
+    m_UnloadDistance = unload_distance;
 }
 
-std::size_t World_ChunkManager::GetLoadingDiameter() const
+void World_ChunkManager::SetChunkMemoryBudget(std::size_t budget_bytes)
 {
-    return GetLoadingDistance() * 2 + 1;
+    m_ChunkMemoryBudget = budget_bytes;
 }
 
-void World_ChunkManager::JobLoop()
+void World_ChunkManager::SetGenerationRegionSize(std::size_t region_size)
 {
-    while (true)
+    m_GenerationRegionSize.store(std::clamp<std::size_t>(region_size, 1, MAX_GENERATION_REGION_SIZE), std::memory_order_relaxed);
+}
+
+void World_ChunkManager::SetPollingDispatch(bool enable)
+{
+    m_PollingDispatch.store(enable, std::memory_order_relaxed);
+}
+
+std::size_t World_ChunkManager::GetUnloadDistance() const
+{
+    // Jobs of the loading area reach one ring further, which must never be unloaded.
+    return std::max(m_UnloadDistance, GetLoadingDistance() + 2);
+}
+
+void World_ChunkManager::UnloadChunks_MainThread()
+{
+    const int unload_distance = static_cast<int>(GetUnloadDistance());
+
+    std::vector<World_Chunk*> candidates;
+    std::size_t usage = 0;
+
     {
-        Job job;
+        std::lock_guard<std::mutex> lock{ m_ChunkMapMutex };
 
+        for (const auto& [id, chunk] : m_ChunkMap)
         {
-            std::unique_lock lock{ m_JobQueueMutex };
+            usage += chunk->MemoryUsage.load(std::memory_order_relaxed);
 
-            m_JobQueueCond.wait(lock, [this]() { return m_JobRetire.load(std::memory_order_acquire) || !m_JobQueue.empty(); });
+            if (std::abs(id.x - m_CurrentChunkID.x) <= unload_distance && std::abs(id.z - m_CurrentChunkID.z) <= unload_distance) continue;
 
-            if (m_JobRetire.load(std::memory_order_acquire)) return;
+            if (chunk->PinCount().load(std::memory_order_acquire) != 0) continue;
 
-            job = m_JobQueue.front(); m_JobQueue.pop();
-
-            job.Chunk->EnqueuedStates.fetch_and(static_cast<std::uint8_t>(~JobBit(job.Type)), std::memory_order_acq_rel);
+            candidates.push_back(chunk.get());
         }
+    }
+
+    m_ChunkMemoryUsage.store(usage, std::memory_order_relaxed);
 
-        if (job.Type == JobType::Generation)
+    if (usage <= m_ChunkMemoryBudget || candidates.empty()) return;
+
+    // Least recently required first.
+    std::sort(candidates.begin(), candidates.end(), [](const World_Chunk* a, const World_Chunk* b) { return a->LastRequiredTick < b->LastRequiredTick; });
+
+    std::vector<World_Chunk_ID> retired_ids;
+
+    for (World_Chunk* chunk : candidates)
+    {
+        if (usage <= m_ChunkMemoryBudget) break;
+
+        usage -= chunk->MemoryUsage.load(std::memory_order_relaxed);
+
+        // Jobs popped from now on drop this chunk, readers stop following neighbour pointers into it.
+        // Beyond the loading area, its grid slot normally holds another chunk already.
+        m_ChunkGrid.Clear_MainThread(chunk);
+
+        chunk->Retired().store(true, std::memory_order_seq_cst);
+        chunk->NeighboursSet().store(false, std::memory_order_seq_cst);
+
+        for (World_Chunk* neighbour : chunk->Neighbours)
         {
-            GenerationJobHandler(job.Chunk);
+            if (neighbour != nullptr) neighbour->NeighboursSet().store(false, std::memory_order_seq_cst);
         }
-        else if (job.Type == JobType::LocalLighting)
+
+        retired_ids.push_back(chunk->ID);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{ m_ChunkMapMutex };
+
+        const std::uint64_t epoch = World_Chunk_GetReclamation().Retire();
+
+        for (const auto& id : retired_ids)
         {
-            LocalLightingJobHandler(job.Chunk);
+            auto iter = m_ChunkMap.find(id);
+
+            m_RetiredChunks.emplace(id, UnloadingChunk{ std::move(iter->second), epoch });
+            m_ChunkMap.erase(iter);
         }
-        else if (job.Type == JobType::NeighbourLighting)
+    }
+
+    m_ChunkRetireCount.fetch_add(1, std::memory_order_release);
+
+    m_ChunkMemoryUsage.store(usage, std::memory_order_relaxed);
+
+    m_UnloadedChunkIDs.insert(m_UnloadedChunkIDs.end(), retired_ids.begin(), retired_ids.end());
+}
+
+void World_ChunkManager::ReclaimChunks_MainThread()
+{
+    auto& reclamation = World_Chunk_GetReclamation();
+
+    // Detach retired chunks no reader can be inside anymore.
+    const std::size_t detached_begin = m_DetachedChunks.size();
+
+    for (auto iter = m_RetiredChunks.begin(); iter != m_RetiredChunks.end();)
+    {
+        if (!reclamation.IsSafe(iter->second.Epoch)) { ++iter; continue; }
+
+        World_Chunk* chunk = iter->second.Chunk.get();
+
+        for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
         {
-            NeighbourLightingJobHandler(job.Chunk);
+            World_Chunk* neighbour = chunk->Neighbours[n].exchange(nullptr, std::memory_order_seq_cst);
+
+            if (neighbour == nullptr) continue;
+
+            World_Chunk* expected = chunk;
+            neighbour->Neighbours[(std::size_t)World_Chunk_OppositeNeighbour(static_cast<World_Chunk_Neighbour>(n))]
+                .compare_exchange_strong(expected, nullptr, std::memory_order_seq_cst);
         }
+
+        m_DetachedChunks.push_back(std::move(iter->second));
+
+        iter = m_RetiredChunks.erase(iter);
     }
+
+    if (detached_begin != m_DetachedChunks.size())
+    {
+        const std::uint64_t epoch = reclamation.Retire();
+
+        for (std::size_t i = detached_begin; i < m_DetachedChunks.size(); i++) m_DetachedChunks[i].Epoch = epoch;
+    }
+
+    // Free detached chunks no reader or job can reach anymore.
+    const std::size_t freed = std::erase_if(m_DetachedChunks, [&reclamation](const UnloadingChunk& unloading)
+    {
+        return reclamation.IsSafe(unloading.Epoch) && unloading.Chunk->PinCount().load(std::memory_order_acquire) == 0;
+    });
+
+    m_UnloadedChunkCount.fetch_add(freed, std::memory_order_relaxed);
+}
+
+std::size_t World_ChunkManager::GetLoadingDistance() const
+{
+    return m_RenderDistance + LOADING_MARGIN;
 }
 
-void World_ChunkManager::EnqueueDedupJob_ThreadSafeWithNotify(Job job)
+std::size_t World_ChunkManager::GetLoadingDiameter() const
 {
-    if (job.Chunk->EnqueuedStates.fetch_or(JobBit(job.Type), std::memory_order_relaxed) & JobBit(job.Type)) return;
+    return GetLoadingDistance() * 2 + 1;
+}
 
-    {
-        std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+float World_ChunkManager::CalculateJobPriority(const Job& job) const
+{
+    const float dx = static_cast<float>(job.Chunk->ID.x - m_PriorityCenterID.x);
+    const float dz = static_cast<float>(job.Chunk->ID.z - m_PriorityCenterID.z);
+
+    float priority = dx * dx + dz * dz;
+
+    // Chunks within the view cone gets a bonus. Center chunk is always considered in view.
+    const float distance = std::sqrt(priority);
 
-        m_JobQueue.push(job);
+    if (distance < 1e-4f || (dx * m_PriorityViewDirection.x + dz * m_PriorityViewDirection.z) / distance >= m_PriorityViewCosHalfAngle)
+    {
+        priority *= VIEW_CONE_PRIORITY_SCALE;
     }
 
-    m_JobQueueCond.notify_one();
+    return priority + JOB_TYPE_PRIORITY_BIAS * static_cast<float>(job.Type);
 }
 
-void World_ChunkManager::EnqueueDedupJob_ThreadUnsafe(Job job)
+void World_ChunkManager::ReprioritizeJobs_ThreadUnsafe()
 {
-    if (job.Chunk->EnqueuedStates.fetch_or(JobBit(job.Type), std::memory_order_relaxed) & JobBit(job.Type)) return;
+    for (auto& job : m_JobQueue) job.Priority = CalculateJobPriority(job);
 
-    m_JobQueue.push(job);
+    std::make_heap(m_JobQueue.begin(), m_JobQueue.end(), JobHeapCompare);
 }
 
-void World_ChunkManager::GenerationJobHandler(World_Chunk* chunk)
+bool World_ChunkManager::IsOutsideWindow(const Job& job, const CancelWindow& window)
 {
-    // Called chunk is in Stage==Empty -> ready for terrain/cave generation.
-    auto expected = World_Chunk_Stage::Empty;
-    if (!chunk->Stage.compare_exchange_strong(expected, World_Chunk_Stage::GenerationInProgress, std::memory_order_acq_rel, std::memory_order_acquire)) return;
+    return std::abs(job.Chunk->ID.x - window.CenterID.x) > window.Distance
+        || std::abs(job.Chunk->ID.z - window.CenterID.z) > window.Distance;
+}
 
-    World_Generation_GenerateChunk(chunk);
+bool World_ChunkManager::IsJobCancelled(const Job& job, CancelWindow& cached_window)
+{
+    // Called after the job's EnqueuedStates bit is cleared.
+    // If the main thread re-requested this chunk while the bit was still set, it published the new epoch before that,
+    // so the chunk is checked against the new window instead of being dropped by a stale one.
+    if (m_CancelEpoch.load(std::memory_order_seq_cst) != cached_window.Epoch)
+    {
+        std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+
+        cached_window = m_CancelWindow;
+    }
 
-    chunk->Stage.store(World_Chunk_Stage::GenerationComplete, std::memory_order_release);
+    // Unloading chunks, and chunks whose neighbours are being unloaded.
+    // Called within a World_ChunkReadGuard, so neighbour pointers stay valid once NeighboursSet is seen.
+    if (job.Chunk->Retired().load(std::memory_order_seq_cst)) return true;
+
+    if (job.Type != JobType::Generation && !job.Chunk->NeighboursSet().load(std::memory_order_seq_cst)) return true;
+
+    return IsOutsideWindow(job, cached_window);
 }
 
-void World_ChunkManager::LocalLightingJobHandler(World_Chunk* chunk)
+void World_ChunkManager::SweepCancelledJobs_ThreadUnsafe()
 {
-    // Called chunk has to be in Stage==GenerationComplete state 
-    if (chunk->Stage.load(std::memory_order_acquire) < World_Chunk_Stage::GenerationComplete)
+    auto cancelled = std::remove_if(m_JobQueue.begin(), m_JobQueue.end(), [this](const Job& job)
     {
-        {
-            std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+        if (!IsOutsideWindow(job, m_CancelWindow)) return false;
 
-            EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::Generation });
-            EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::LocalLighting });
-        }
+        job.Chunk->EnqueuedStates().fetch_and(static_cast<std::uint8_t>(~JobBit(job.Type)), std::memory_order_seq_cst);
+        job.Chunk->EnqueuedStates().fetch_or(CancelledJobBit(job.Type), std::memory_order_relaxed);
+        job.Chunk->PinCount().fetch_sub(1, std::memory_order_release);
 
-        m_JobQueueCond.notify_one();
+        m_JobTelemetry[static_cast<std::size_t>(job.Type)].Discarded.fetch_add(1, std::memory_order_relaxed);
 
-        return;
+        return true;
+    });
+
+    m_CancelledJobCount.fetch_add(static_cast<std::uint64_t>(m_JobQueue.end() - cancelled), std::memory_order_relaxed);
+
+    m_JobQueue.erase(cancelled, m_JobQueue.end());
+
+    m_JobQueueSize.store(m_JobQueue.size(), std::memory_order_release);
+}
+
+void World_ChunkManager::RecordTimeToRenderable(double seconds)
+{
+    std::lock_guard<std::mutex> lock{ m_TimeToRenderableMutex };
+
+    if (m_TimeToRenderableSamples.size() < TIME_TO_RENDERABLE_CAPACITY)
+    {
+        m_TimeToRenderableSamples.push_back(seconds);
     }
+    else
+    {
+        m_TimeToRenderableSamples[m_TimeToRenderableNext] = seconds;
+    }
+
+    m_TimeToRenderableNext = (m_TimeToRenderableNext + 1) % TIME_TO_RENDERABLE_CAPACITY;
+}
+
+World_ChunkManager::PackedJob World_ChunkManager::PackJob(Job job)
+{
+    static_assert(alignof(World_Chunk) >= 4, "JobType is packed into the low two bits of World_Chunk*");
+    static_assert(std::tuple_size_v<decltype(World_Chunk::JobEnqueueTimes)> == (std::size_t)JobType::COUNT);
+
+    return reinterpret_cast<PackedJob>(job.Chunk) | static_cast<PackedJob>(job.Type);
+}
+
+World_ChunkManager::Job World_ChunkManager::UnpackJob(PackedJob packed)
+{
+    return Job{ reinterpret_cast<World_Chunk*>(packed & ~PackedJob{ 3 }), static_cast<JobType>(packed & PackedJob{ 3 }) };
+}
+
+bool World_ChunkManager::RunTask(std::size_t worker_index)
+{
+    CurrentWorkerIndex = worker_index;
+
+    std::optional<Job> job_opt = TryPopJob(worker_index);
+
+    if (!job_opt.has_value()) return false;
+
+    Job job = job_opt.value();
+
+    JobTelemetry& telemetry = m_JobTelemetry[static_cast<std::size_t>(job.Type)];
+
+    // Read before the dedup bit is cleared, a new enqueue of this job overwrites it.
+    const double start_time = Time_GetTime();
+
+    telemetry.QueueWait.RecordSeconds(start_time - job.Chunk->JobEnqueueTimes[static_cast<std::size_t>(job.Type)].load(std::memory_order_relaxed));
+
+    job.Chunk->EnqueuedStates().fetch_and(static_cast<std::uint8_t>(~JobBit(job.Type)), std::memory_order_seq_cst);
 
-    // Called chunk's neighbours have to be in Stage>=GenerationComplete state
     {
-        std::array<World_Chunk*, static_cast<std::size_t>(World_Chunk_Neighbour::COUNT)> missings{};
-        auto missings_iter = missings.begin();
+        World_ChunkReadGuard guard;
 
-        for (auto neighbour : chunk->Neighbours)
+        // Dropped without touching the chunk, it gets requested again if it re-enters the render area.
+        if (IsJobCancelled(job, m_WorkerCancelWindows[worker_index]))
         {
-            if (neighbour->Stage.load(std::memory_order_acquire) >= World_Chunk_Stage::GenerationComplete) continue;
+            job.Chunk->EnqueuedStates().fetch_or(CancelledJobBit(job.Type), std::memory_order_relaxed);
 
-            *missings_iter = neighbour;
-            missings_iter++;
+            m_CancelledJobCount.fetch_add(1, std::memory_order_relaxed);
+            telemetry.Discarded.fetch_add(1, std::memory_order_relaxed);
         }
-
+        else
         {
-            std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+            m_ExecutedJobCount.fetch_add(1, std::memory_order_relaxed);
+
+            bool ran = false;
 
-            for (auto iter = missings.begin(); iter != missings_iter; ++iter)
+            if (job.Type == JobType::Generation)
+            {
+                ran = GenerationJobHandler(job.Chunk);
+            }
+            else if (job.Type == JobType::LocalLighting)
             {
-                EnqueueDedupJob_ThreadUnsafe(Job{ *iter, JobType::Generation });
+                ran = LocalLightingJobHandler(job.Chunk);
+            }
+            else if (job.Type == JobType::NeighbourLighting)
+            {
+                ran = NeighbourLightingJobHandler(job.Chunk);
             }
 
-            if (missings_iter != missings.begin())
+            if (ran)
+            {
+                telemetry.Executed.fetch_add(1, std::memory_order_relaxed);
+                telemetry.Execution.RecordSeconds(Time_GetTime() - start_time);
+            }
+            else
             {
-                EnqueueDedupJob_ThreadUnsafe(Job{ chunk, JobType::LocalLighting });
+                telemetry.Discarded.fetch_add(1, std::memory_order_relaxed);
             }
         }
 
-        if (missings_iter != missings.begin())
+        job.Chunk->PinCount().fetch_sub(1, std::memory_order_release);
+    }
+
+    return true;
+}
+
+std::optional<World_ChunkManager::Job> World_ChunkManager::TryPopJob(std::size_t worker_index)
+{
+    // Own deque first, follow-up jobs are prerequisites of the job this worker just ran.
+    if (auto packed = m_WorkerDeques[worker_index]->Pop(); packed.has_value())
+    {
+        return UnpackJob(packed.value());
+    }
+
+    // Then the prioritized global queue.
+    if (m_JobQueueSize.load(std::memory_order_acquire) != 0)
+    {
+        std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+
+        if (!m_JobQueue.empty())
         {
-            m_JobQueueCond.notify_one();
-            return;
+            std::pop_heap(m_JobQueue.begin(), m_JobQueue.end(), JobHeapCompare);
+            Job job = m_JobQueue.back(); m_JobQueue.pop_back();
+
+            m_JobQueueSize.store(m_JobQueue.size(), std::memory_order_release);
+
+            return job;
         }
     }
 
-    // Above conditionas are met -> start propagating local lights
-    World_Chunk_Stage expected = World_Chunk_Stage::GenerationComplete;
-    if (!chunk->Stage.compare_exchange_strong(expected, World_Chunk_Stage::LocalLightingInProgress, std::memory_order_acq_rel, std::memory_order_acquire)) return;
+    // Then steal from other workers.
+    for (std::size_t i = 1; i < m_WorkerDeques.size(); i++)
+    {
+        auto& victim = m_WorkerDeques[(worker_index + i) % m_WorkerDeques.size()];
 
-    World_Light_PropagateInitialSunlight(chunk);
+        if (auto packed = victim->Steal(); packed.has_value())
+        {
+            return UnpackJob(packed.value());
+        }
+    }
 
-    chunk->Stage.store(World_Chunk_Stage::LocalLightingComplete, std::memory_order_release);
+    return std::nullopt;
 }
 
-void World_ChunkManager::NeighbourLightingJobHandler(World_Chunk* chunk)
+bool World_ChunkManager::HasTasks() const
 {
-    // Called chunk has to be in Stage==LocalLightingComplete.
-    if (chunk->Stage.load(std::memory_order_acquire) < World_Chunk_Stage::LocalLightingComplete)
+    if (m_JobQueueSize.load(std::memory_order_seq_cst) != 0) return true;
+
+    for (const auto& deque : m_WorkerDeques)
     {
-        {
-            std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+        if (!deque->Empty()) return true;
+    }
 
-            EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::LocalLighting });
-            EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::NeighbourLighting});
-        }
+    return false;
+}
 
-        m_JobQueueCond.notify_one();
+void World_ChunkManager::RecordEnqueue(const Job& job, std::uint8_t previous_enqueued_states)
+{
+    JobTelemetry& telemetry = m_JobTelemetry[static_cast<std::size_t>(job.Type)];
 
-        return;
+    telemetry.Enqueued.fetch_add(1, std::memory_order_relaxed);
+
+    if (previous_enqueued_states & CancelledJobBit(job.Type))
+    {
+        job.Chunk->EnqueuedStates().fetch_and(static_cast<std::uint8_t>(~CancelledJobBit(job.Type)), std::memory_order_relaxed);
+
+        telemetry.Requeued.fetch_add(1, std::memory_order_relaxed);
     }
 
-    // Called chunk's neighbours have to be in Stage>=LocalLightingComplete state.
+    job.Chunk->JobEnqueueTimes[static_cast<std::size_t>(job.Type)].store(Time_GetTime(), std::memory_order_relaxed);
+}
+
+void World_ChunkManager::EnqueueDedupJob_ThreadUnsafe(Job job)
+{
+    const std::uint8_t previous = job.Chunk->EnqueuedStates().fetch_or(JobBit(job.Type), std::memory_order_seq_cst);
+
+    if (previous & JobBit(job.Type)) return;
+
+    RecordEnqueue(job, previous);
+
+    job.Chunk->PinCount().fetch_add(1, std::memory_order_relaxed);
+
+    job.Priority = CalculateJobPriority(job);
+
+    m_JobQueue.push_back(job);
+    std::push_heap(m_JobQueue.begin(), m_JobQueue.end(), JobHeapCompare);
+
+    m_JobQueueSize.store(m_JobQueue.size(), std::memory_order_release);
+}
+
+void World_ChunkManager::EnqueueDedupJob_WorkerLocal(Job job)
+{
+    const std::uint8_t previous = job.Chunk->EnqueuedStates().fetch_or(JobBit(job.Type), std::memory_order_relaxed);
+
+    if (previous & JobBit(job.Type)) return;
+
+    RecordEnqueue(job, previous);
+
+    job.Chunk->PinCount().fetch_add(1, std::memory_order_relaxed);
+
+    m_WorkerDeques[CurrentWorkerIndex]->Push(PackJob(job));
+}
+
+bool World_ChunkManager::ArmDependencies(World_Chunk* chunk, std::atomic<std::uint16_t>& (World_Chunk::* pending)() const, World_Chunk_Stage prerequisite_stage)
+{
+    auto& mask = (chunk->*pending)();
+
+    // Arm with every prerequisite pending, then clear the ones already complete.
+    // Completing workers clear their bit after publishing their stage, so every bit gets cleared by one side or both.
+    if ((mask.load(std::memory_order_seq_cst) & DEPENDENCY_ARMED) == 0)
     {
-        std::array<World_Chunk*, static_cast<std::size_t>(World_Chunk_Neighbour::COUNT)> missings{};
-        auto missings_iter = missings.begin();
+        mask.store(DEPENDENCY_ARMED | DEPENDENCY_ALL, std::memory_order_seq_cst);
+    }
 
-        for (auto neighbour : chunk->Neighbours)
+    std::uint16_t completes = 0;
+
+    for (std::size_t n = 0; n < (std::size_t)World_Chunk_Neighbour::COUNT; n++)
+    {
+        if (chunk->Neighbours[n].load(std::memory_order_seq_cst)->Stage().load(std::memory_order_seq_cst) >= prerequisite_stage)
         {
-            if (neighbour->Stage.load(std::memory_order_acquire) >= World_Chunk_Stage::LocalLightingComplete) continue;
+            completes |= static_cast<std::uint16_t>(1u << n);
+        }
+    }
+
+    if (chunk->Stage().load(std::memory_order_seq_cst) >= prerequisite_stage) completes |= DEPENDENCY_SELF;
+
+    const std::uint16_t prev = mask.fetch_and(static_cast<std::uint16_t>(~completes), std::memory_order_seq_cst);
+
+    // Ready once nothing is pending. This also holds for a job that was enqueued before and cancelled since,
+    // re-enqueuing an already queued one is deduplicated.
+    return (prev & DEPENDENCY_ALL & ~completes) == 0;
+}
+
+void World_ChunkManager::NotifyDependents(World_Chunk* chunk, std::atomic<std::uint16_t>& (World_Chunk::* pending)() const, JobType dependent_job)
+{
+    bool enqueued = false;
 
-            *missings_iter = neighbour;
-            missings_iter++;
+    // Dependents are this chunk and its neighbours, whose mask holds this chunk under the opposite direction.
+    for (std::size_t n = 0; n <= (std::size_t)World_Chunk_Neighbour::COUNT; n++)
+    {
+        World_Chunk* dependent = nullptr;
+        std::uint16_t bit = 0;
+
+        if (n == (std::size_t)World_Chunk_Neighbour::COUNT)
+        {
+            dependent = chunk;
+            bit = DEPENDENCY_SELF;
         }
+        else
+        {
+            dependent = chunk->Neighbours[n].load(std::memory_order_seq_cst);
+            bit = static_cast<std::uint16_t>(1u << (std::size_t)World_Chunk_OppositeNeighbour(static_cast<World_Chunk_Neighbour>(n)));
+        }
+
+        if (dependent == nullptr) continue;
+
+        const std::uint16_t prev = (dependent->*pending)().fetch_and(static_cast<std::uint16_t>(~bit), std::memory_order_seq_cst);
 
+        if ((prev & DEPENDENCY_ARMED) && (prev & DEPENDENCY_ALL) == bit)
         {
-            std::lock_guard<std::mutex> lock{ m_JobQueueMutex };
+            EnqueueDedupJob_WorkerLocal({ dependent, dependent_job });
+            enqueued = true;
+        }
+    }
 
-            for (auto iter = missings.begin(); iter != missings_iter; ++iter)
-            {
-                EnqueueDedupJob_ThreadUnsafe(Job{ *iter, JobType::LocalLighting });
-            }
+    if (enqueued) m_Scheduler.Notify();
+}
 
-            if (missings_iter != missings.begin())
-            {
-                EnqueueDedupJob_ThreadUnsafe(Job{ chunk, JobType::NeighbourLighting });
-            }
+void World_ChunkManager::RequestLocalLighting_ThreadUnsafe(World_Chunk* chunk)
+{
+    // Requested chunks are within the render area's ring2, which are neighbour set.
+    assert(chunk->NeighboursSet().load(std::memory_order_acquire));
+
+    if (chunk->Stage().load(std::memory_order_acquire) >= World_Chunk_Stage::LocalLightingInProgress) return;
+
+    if (ArmDependencies(chunk, &World_Chunk::PendingGenerations, World_Chunk_Stage::GenerationComplete))
+    {
+        EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::LocalLighting });
+    }
+
+    if (chunk->Stage().load(std::memory_order_acquire) == World_Chunk_Stage::Empty)
+    {
+        EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::Generation });
+    }
+
+    for (World_Chunk* neighbour : chunk->Neighbours)
+    {
+        if (neighbour->Stage().load(std::memory_order_acquire) == World_Chunk_Stage::Empty)
+        {
+            EnqueueDedupJob_ThreadUnsafe({ neighbour, JobType::Generation });
         }
+    }
+}
 
-        if (missings_iter != missings.begin())
+void World_ChunkManager::RequestNeighbourLighting_ThreadUnsafe(World_Chunk* chunk)
+{
+    if (chunk->Stage().load(std::memory_order_acquire) >= World_Chunk_Stage::NeighbourLightingInProgress) return;
+
+    // Prerequisites are enqueued by the job itself, see PollDependencies.
+    if (m_PollingDispatch.load(std::memory_order_relaxed))
+    {
+        EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::NeighbourLighting });
+        return;
+    }
+
+    if (ArmDependencies(chunk, &World_Chunk::PendingLocalLightings, World_Chunk_Stage::LocalLightingComplete))
+    {
+        EnqueueDedupJob_ThreadUnsafe({ chunk, JobType::NeighbourLighting });
+    }
+
+    if (chunk->Stage().load(std::memory_order_acquire) < World_Chunk_Stage::LocalLightingComplete)
+    {
+        RequestLocalLighting_ThreadUnsafe(chunk);
+    }
+
+    for (World_Chunk* neighbour : chunk->Neighbours)
+    {
+        if (neighbour->Stage().load(std::memory_order_acquire) < World_Chunk_Stage::LocalLightingComplete)
         {
-            m_JobQueueCond.notify_one();
-            return;
+            RequestLocalLighting_ThreadUnsafe(neighbour);
         }
     }
+}
+
+bool World_ChunkManager::PollDependencies(Job job, JobType prerequisite_job, World_Chunk_Stage prerequisite_stage)
+{
+    std::array<World_Chunk*, (std::size_t)World_Chunk_Neighbour::COUNT + 1> missings{};
+    std::size_t missing_count = 0;
+
+    if (job.Chunk->Stage().load(std::memory_order_acquire) < prerequisite_stage) missings[missing_count++] = job.Chunk;
+
+    for (World_Chunk* neighbour : job.Chunk->Neighbours)
+    {
+        if (neighbour->Stage().load(std::memory_order_acquire) < prerequisite_stage) missings[missing_count++] = neighbour;
+    }
+
+    if (missing_count == 0) return true;
+
+    // Pushed in reverse, the worker deque pops LIFO.
+    EnqueueDedupJob_WorkerLocal(job);
+
+    for (std::size_t i = 0; i < missing_count; i++) EnqueueDedupJob_WorkerLocal({ missings[i], prerequisite_job });
+
+    m_WastedJobCount.fetch_add(1, std::memory_order_relaxed);
+
+    m_Scheduler.Notify();
+
+    return false;
+}
+
+bool World_ChunkManager::GenerationJobHandler(World_Chunk* chunk)
+{
+    const int region_size = static_cast<int>(m_GenerationRegionSize.load(std::memory_order_relaxed));
+
+    // Called chunk is in Stage==Empty -> ready for terrain/cave generation.
+    auto expected = World_Chunk_Stage::Empty;
+    if (!chunk->Stage().compare_exchange_strong(expected, World_Chunk_Stage::GenerationInProgress, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        // Normally generated by another chunk's job along with its region.
+        if (region_size == 1) m_WastedJobCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Claim the other chunks of the region still waiting for generation. Their own jobs find them taken and are discarded.
+    // Only chunks that get requested are claimed: the loading area's outermost ring never is.
+    // Claimed chunks are pinned like the job's chunk, the read guard of RunTask keeps the ones unloaded meanwhile alive.
+    const World_Chunk_ID region_origin{ FloorDiv(chunk->ID.x, region_size) * region_size, 0, FloorDiv(chunk->ID.z, region_size) * region_size };
+
+    CancelWindow window = m_WorkerCancelWindows[CurrentWorkerIndex];
+    window.Distance--;
+
+    std::array<World_Chunk*, MAX_GENERATION_REGION_SIZE * MAX_GENERATION_REGION_SIZE> claimed{};
+
+    glm::ivec2 claimed_min{ chunk->ID.x - region_origin.x, chunk->ID.z - region_origin.z };
+    glm::ivec2 claimed_max = claimed_min;
+
+    claimed[claimed_min.x + claimed_min.y * region_size] = chunk;
+
+    for (int rz = 0; rz < region_size; rz++)
+    for (int rx = 0; rx < region_size; rx++)
+    {
+        World_Chunk* peer = m_ChunkGrid.Find(region_origin + World_Chunk_ID{ rx, 0, rz });
+
+        if (peer == nullptr || peer == chunk) continue;
+        if (IsOutsideWindow({ peer, JobType::Generation }, window)) continue;
+
+        peer->PinCount().fetch_add(1, std::memory_order_acq_rel);
+
+        auto peer_expected = World_Chunk_Stage::Empty;
+
+        if (peer->Retired().load(std::memory_order_seq_cst)
+            || !peer->Stage().compare_exchange_strong(peer_expected, World_Chunk_Stage::GenerationInProgress, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            peer->PinCount().fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        claimed[rx + rz * region_size] = peer;
+
+        claimed_min = glm::min(claimed_min, glm::ivec2(rx, rz));
+        claimed_max = glm::max(claimed_max, glm::ivec2(rx, rz));
+    }
+
+    // Bounding box of the claimed chunks.
+    const glm::ivec2 box_size = claimed_max - claimed_min + 1;
+
+    std::array<World_Chunk*, MAX_GENERATION_REGION_SIZE * MAX_GENERATION_REGION_SIZE> box{};
+
+    for (int z = 0; z < box_size.y; z++)
+    for (int x = 0; x < box_size.x; x++)
+    {
+        box[x + z * box_size.x] = claimed[(claimed_min.x + x) + (claimed_min.y + z) * region_size];
+    }
+
+    World_Generation_GenerateRegion(region_origin + World_Chunk_ID{ claimed_min.x, 0, claimed_min.y }, box_size, box.data());
+
+    std::uint64_t batched = 0;
+
+    for (World_Chunk* generated : box)
+    {
+        if (generated == nullptr) continue;
+
+        generated->UpdateMemoryUsage();
+
+        generated->Stage().store(World_Chunk_Stage::GenerationComplete, std::memory_order_seq_cst);
+
+        NotifyDependents(generated, &World_Chunk::PendingGenerations, JobType::LocalLighting);
+
+        if (generated == chunk) continue;
+
+        generated->PinCount().fetch_sub(1, std::memory_order_release);
+        batched++;
+    }
+
+    m_JobTelemetry[static_cast<std::size_t>(JobType::Generation)].Batched.fetch_add(batched, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool World_ChunkManager::LocalLightingJobHandler(World_Chunk* chunk)
+{
+    // Only enqueued once the called chunk and its neighbours are in Stage>=GenerationComplete, unless polling.
+    if (m_PollingDispatch.load(std::memory_order_relaxed) && !PollDependencies({ chunk, JobType::LocalLighting }, JobType::Generation, World_Chunk_Stage::GenerationComplete))
+    {
+        return false;
+    }
+
+    World_Chunk_Stage expected = World_Chunk_Stage::GenerationComplete;
+    if (!chunk->Stage().compare_exchange_strong(expected, World_Chunk_Stage::LocalLightingInProgress, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        m_WastedJobCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Lighting of the neighbours may still spill into this chunk: no snapshot before neighbour lighting.
+    World_Light_PropagateInitialSunlight(chunk);
+
+    chunk->Stage().store(World_Chunk_Stage::LocalLightingComplete, std::memory_order_seq_cst);
+
+    NotifyDependents(chunk, &World_Chunk::PendingLocalLightings, JobType::NeighbourLighting);
+
+    return true;
+}
+
+bool World_ChunkManager::NeighbourLightingJobHandler(World_Chunk* chunk)
+{
+    // Only enqueued once the called chunk and its neighbours are in Stage>=LocalLightingComplete, unless polling.
+    if (m_PollingDispatch.load(std::memory_order_relaxed) && !PollDependencies({ chunk, JobType::NeighbourLighting }, JobType::LocalLighting, World_Chunk_Stage::LocalLightingComplete))
+    {
+        return false;
+    }
 
-    // Above conditions are met -> called chunk's lighting is complete (for now).
     World_Chunk_Stage expected = World_Chunk_Stage::LocalLightingComplete;
-    if (!chunk->Stage.compare_exchange_strong(expected, World_Chunk_Stage::NeighbourLightingInProgress, std::memory_order_acq_rel, std::memory_order_acquire)) return;
+    if (!chunk->Stage().compare_exchange_strong(expected, World_Chunk_Stage::NeighbourLightingInProgress, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        m_WastedJobCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
 
     // TODO: neighbour light propagation
 
-    chunk->StorageVersion.fetch_add(1, std::memory_order_relaxed);
+    // The 3x3 chunks have completed local lighting, nothing else writes this chunk: the sections are handed over.
+    const std::uint32_t version = chunk->StorageVersion().load(std::memory_order_relaxed) + 1;
+
+    chunk->PublishSnapshot(version);
+
+    // Nothing else writes the chunk here or during generation, neighbours' lighting spills into it in between.
+    chunk->UpdateMemoryUsage();
+
+    chunk->StorageVersion().store(version, std::memory_order_release);
+
+    chunk->Stage().store(World_Chunk_Stage::NeighbourLightingComplete, std::memory_order_release);
+
+    if (double request_time = chunk->RenderRequestTime.exchange(0.0, std::memory_order_relaxed); request_time != 0.0)
+    {
+        RecordTimeToRenderable(Time_GetTime() - request_time);
+    }
 
-    chunk->Stage.store(World_Chunk_Stage::NeighbourLightingComplete, std::memory_order_release);
+    return true;
 }
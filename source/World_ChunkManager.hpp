@@ -1,82 +1,273 @@
 #pragma once
 
 #include <cstdint>
+#include <array>
 #include <optional>
 #include <vector>
-#include <queue>
 #include <unordered_map>
-#include <thread>
 #include <mutex>
 #include <atomic>
-#include <condition_variable>
 #include "World_Coordinate.hpp"
 #include "World_Chunk.hpp"
+#include "World_ChunkGrid.hpp"
+#include "Utility_WorkStealingDeque.hpp"
+#include "Utility_TaskScheduler.hpp"
+#include "Utility_JobTelemetry.hpp"
 
-class World_ChunkManager
+// Generation and lighting jobs run on the scheduler's workers as TaskType::Chunk tasks.
+class World_ChunkManager : private TaskQueue
 {
 public:
-    World_ChunkManager();
+    explicit World_ChunkManager(TaskScheduler& scheduler);
     ~World_ChunkManager();
 
+    // Chunk construction job types, in pipeline order.
+    enum class JobType
+    {
+        Generation,
+        LocalLighting,
+        NeighbourLighting,
+
+        COUNT,
+    };
+
     // Called from main thread per frame.
-    void SetCenterChunk_MainThread(World_Chunk_ID center_id);
+    // view_direction and view_half_angle describe the camera's horizontal view cone, used for job prioritization.
+    void SetCenterChunk_MainThread(World_Chunk_ID center_id, glm::vec3 view_direction, float view_half_angle);
 
     std::vector<World_Chunk*> GetChunksInRenderArea_MainThread() const;
 
     // Queries
     std::size_t GetRenderDistance()     const { return m_RenderDistance; }
-    std::size_t GetWorkerThreadCount()  const { return m_WorkerCount; }
     std::size_t GetLoadedChunkCount()   const { std::lock_guard<std::mutex> lock{ m_ChunkMapMutex }; return m_ChunkMap.size(); };
 
+    // Lock-free within the loading area, other loaded chunks are looked up under a mutex.
+    // Called from main thread, or from other threads within a World_ChunkReadGuard.
     std::optional<const World_Chunk*> GetChunkAt(World_GlobalXYZ global) const;
 
+    // Latest snapshot of the loaded chunk at global, null if not loaded or without snapshot yet. Callable from any thread.
+    // The last snapshot looked up is cached per thread: repeated lookups within a chunk take no lock, guard or reference.
+    // Valid until the calling thread's next lookup.
+    const World_ChunkSnapshot* GetChunkSnapshotAt(World_GlobalXYZ global) const;
+
+    // Time from a chunk entering the inner ring of the render area until it completes neighbour lighting.
+    struct LatencyPercentiles
+    {
+        double      Median      = 0.0; // Seconds
+        double      P99         = 0.0; // Seconds
+        std::size_t SampleCount = 0;
+    };
+
+    LatencyPercentiles GetInnerRingTimeToRenderable() const;
+
+    // Jobs that were run while their prerequisites were unmet or their stage was already taken.
+    // The polling dispatch re-enqueues on each of these, with dependency counting it should stay near zero.
+    std::uint64_t GetWastedJobCount() const { return m_WastedJobCount.load(std::memory_order_relaxed); }
+
+    // Jobs dropped because their chunk left the loading area before a worker got to them, versus jobs that were run.
+    std::uint64_t GetCancelledJobCount() const { return m_CancelledJobCount.load(std::memory_order_relaxed); }
+    std::uint64_t GetExecutedJobCount()  const { return m_ExecutedJobCount.load(std::memory_order_relaxed); }
+
+    const JobTelemetry& GetJobTelemetry(JobType type) const { return m_JobTelemetry[static_cast<std::size_t>(type)]; }
+
+    // Jobs waiting in the global queue and the worker deques, approximate while workers run.
+    std::size_t GetQueuedJobCount() const;
+
+    // Loaded chunks per World_Chunk_Stage. Takes the chunk map lock.
+    std::array<std::size_t, (std::size_t)World_Chunk_Stage::COUNT> GetChunkStageCounts() const;
+
+    // Chunks beyond the unload distance are unloaded, least recently required first, while over the memory budget.
+    std::size_t GetUnloadDistance()     const;
+    std::size_t GetChunkMemoryBudget()  const { return m_ChunkMemoryBudget; }
+    std::size_t GetChunkMemoryUsage()   const { return m_ChunkMemoryUsage.load(std::memory_order_relaxed); }
+    std::size_t GetUnloadedChunkCount() const { return m_UnloadedChunkCount.load(std::memory_order_relaxed); }
+
+    // Generation jobs generate the requested chunks of their aligned GenerationRegionSize^2 region (default 2x2) along with their own,
+    // with one noise grid per node. Fewer, longer generation jobs: a chunk may wait for the rest of its region.
+    std::size_t GetGenerationRegionSize() const { return m_GenerationRegionSize.load(std::memory_order_relaxed); }
+
+    // IDs of chunks unloaded since the last call, for renderers to drop their per-chunk resources.
+    std::vector<World_Chunk_ID> TakeUnloadedChunkIDs_MainThread();
+
     // Modifiers
     void SetRenderDistance(std::size_t render_distance);
+    void SetUnloadDistance(std::size_t unload_distance);
+    void SetChunkMemoryBudget(std::size_t budget_bytes);
+    void SetGenerationRegionSize(std::size_t region_size); // Clamped to [1, MAX_GENERATION_REGION_SIZE], 1 generates chunks one by one
+
+    // Bench only, set before the first SetCenterChunk_MainThread. Dispatches lighting jobs as before dependency counting:
+    // requested chunks get their neighbour lighting job right away, and lighting jobs run before their prerequisites
+    // complete re-enqueue themselves behind them. Bench_ChunkScheduling compares the wasted jobs of both.
+    void SetPollingDispatch(bool enable);
 
 private:
+    static constexpr std::size_t MAX_RENDER_DISTANCE = 32;
+    static constexpr std::size_t LOADING_MARGIN      = 4; // Rings of the loading area around the render area.
+
+    static constexpr std::size_t MAX_GENERATION_REGION_SIZE = 8;
+
     std::size_t m_RenderDistance = 6;
 
     std::size_t GetLoadingDistance() const;
     std::size_t GetLoadingDiameter() const;
 
     World_Chunk_ID m_CurrentChunkID{ -1, -1, -1 };
+    int            m_AreaRenderDistance = -1; // Render distance of the areas around m_CurrentChunkID, -1 before the first update.
 
+    // Owns every loaded chunk. m_ChunkGrid indexes the chunks of the loading area, which covers most lookups.
     std::unordered_map<World_Chunk_ID, std::unique_ptr<World_Chunk>> m_ChunkMap;
     mutable std::mutex m_ChunkMapMutex;
 
-    // Chunk construction job system
-    enum class JobType
+    World_ChunkGrid m_ChunkGrid{ static_cast<int>(2 * (MAX_RENDER_DISTANCE + LOADING_MARGIN) + 1) };
+
+    // Chunk unloading. Main thread only.
+    // Unloading chunks go through three steps, each waiting for readers of the previous one (World_ChunkReadGuard):
+    // 1. Retire   : unlinked from m_ChunkMap, neighbours' NeighboursSet cleared. Resurrected if required again.
+    // 2. Detach   : neighbour pointers to and from the chunk are cleared.
+    // 3. Free     : once no job or meshing request pins the chunk.
+    struct UnloadingChunk
     {
-        Generation,
-        LocalLighting,
-        NeighbourLighting,
+        std::unique_ptr<World_Chunk> Chunk;
+        std::uint64_t                Epoch = 0;
     };
 
+    std::size_t   m_UnloadDistance    = 12;
+    std::size_t   m_ChunkMemoryBudget = std::size_t{ 512 } << 20;
+    std::uint64_t m_CenterTick        = 0;
+
+    std::unordered_map<World_Chunk_ID, UnloadingChunk> m_RetiredChunks;
+    std::vector<UnloadingChunk>                        m_DetachedChunks;
+    std::vector<World_Chunk_ID>                        m_UnloadedChunkIDs;
+
+    std::atomic<std::size_t> m_ChunkMemoryUsage   = 0;
+    std::atomic<std::size_t> m_UnloadedChunkCount = 0;
+
+    // Bumped once retired chunks are unlinked from the grid and the map, invalidating cached lookups.
+    std::atomic<std::uint64_t> m_ChunkRetireCount = 0;
+
+    void UnloadChunks_MainThread();
+    void ReclaimChunks_MainThread();
+
+    // Chunk construction job system
     static constexpr std::uint8_t JobBit(JobType type)
     {
         return static_cast<std::uint8_t>(1u << static_cast<std::uint8_t>(type));
     }
 
+    static constexpr std::uint8_t CancelledJobBit(JobType type)
+    {
+        return static_cast<std::uint8_t>(JobBit(type) << 4);
+    }
+
     struct Job
     {
         World_Chunk* Chunk;
         JobType      Type;
+        float        Priority = 0.0f; // Lower value is popped first.
     };
 
-    std::queue<Job>         m_JobQueue; // TODO: Use priority queue
-    std::atomic<bool>       m_JobRetire = false;
-    std::mutex              m_JobQueueMutex;
-    std::condition_variable m_JobQueueCond;
+    // Job packed into a single word for the lock-free worker deques.
+    // World_Chunk is at least 4-byte aligned, the low two bits hold the JobType.
+    using PackedJob = std::uintptr_t;
 
-    std::vector<std::jthread> m_Workers;
-    std::size_t m_WorkerCount = 0;
+    static PackedJob PackJob(Job job);
+    static Job       UnpackJob(PackedJob packed);
 
-    void JobLoop();
+    // Global queue, fed by the main thread.
+    // Min-heap on Job::Priority, maintained with std::push_heap/std::pop_heap.
+    std::vector<Job>         m_JobQueue;
+    std::atomic<std::size_t> m_JobQueueSize = 0;
+    std::mutex               m_JobQueueMutex;
 
-    // Called from worker thread
-    void EnqueueDedupJob_ThreadSafeWithNotify(Job job);
+    // Prioritization state. Guarded by m_JobQueueMutex.
+    World_Chunk_ID          m_PriorityCenterID{ 0, 0, 0 };
+    glm::vec3               m_PriorityViewDirection{ 0.0f, 0.0f, -1.0f };
+    float                   m_PriorityViewCosHalfAngle = 0.0f;
+
+    float CalculateJobPriority(const Job& job) const;
+    void  ReprioritizeJobs_ThreadUnsafe();
+
+    // Cancellation state.
+    // m_CancelEpoch is bumped by the main thread whenever the center or the loading distance changes.
+    // Workers keep a copy of the cancellation window in m_WorkerCancelWindows, re-read under m_JobQueueMutex when the epoch differs.
+    struct CancelWindow
+    {
+        std::uint64_t  Epoch = 0;
+        World_Chunk_ID CenterID{ 0, 0, 0 };
+        int            Distance = 0;
+    };
+
+    CancelWindow               m_CancelWindow; // Guarded by m_JobQueueMutex.
+    std::vector<CancelWindow>  m_WorkerCancelWindows;
+    std::atomic<std::uint64_t> m_CancelEpoch = 0;
+
+    std::atomic<std::uint64_t> m_CancelledJobCount = 0;
+    std::atomic<std::uint64_t> m_ExecutedJobCount = 0;
+
+    std::array<JobTelemetry, (std::size_t)JobType::COUNT> m_JobTelemetry;
+
+    // Called once the job passed deduplication, before it is published.
+    void RecordEnqueue(const Job& job, std::uint8_t previous_enqueued_states);
+
+    static bool IsOutsideWindow(const Job& job, const CancelWindow& window);
+
+    bool IsJobCancelled(const Job& job, CancelWindow& cached_window);
+    void SweepCancelledJobs_ThreadUnsafe();
+
+    // Time-to-renderable samples of inner ring chunks. Ring buffer of the latest samples.
+    static constexpr int         INNER_RING_DISTANCE         = 2;
+    static constexpr std::size_t TIME_TO_RENDERABLE_CAPACITY = 1024;
+
+    std::vector<double>     m_TimeToRenderableSamples;
+    std::size_t             m_TimeToRenderableNext = 0;
+    mutable std::mutex      m_TimeToRenderableMutex;
+
+    void RecordTimeToRenderable(double seconds);
+
+    // Chunk pipeline dependencies.
+    // A job is enqueued by whoever clears the last bit of its chunk's dependency mask:
+    // either the main thread requesting it, or the worker completing its last prerequisite.
+    // The main thread also re-enqueues ready jobs on later requests, which picks up cancelled ones.
+    static constexpr std::uint16_t DEPENDENCY_SELF  = 1u << static_cast<std::size_t>(World_Chunk_Neighbour::COUNT);
+    static constexpr std::uint16_t DEPENDENCY_ALL   = (DEPENDENCY_SELF << 1) - 1;
+    static constexpr std::uint16_t DEPENDENCY_ARMED = 1u << 15;
+
+    std::atomic<std::uint64_t> m_WastedJobCount = 0;
+    std::atomic<bool>          m_PollingDispatch = false;
+
+    std::atomic<std::size_t> m_GenerationRegionSize = 2;
+
+    bool ArmDependencies(World_Chunk* chunk, std::atomic<std::uint16_t>& (World_Chunk::* pending)() const, World_Chunk_Stage prerequisite_stage);
+    void NotifyDependents(World_Chunk* chunk, std::atomic<std::uint16_t>& (World_Chunk::* pending)() const, JobType dependent_job);
+
+    // Polling dispatch: whether the chunk and its neighbours reached prerequisite_stage. If not, re-enqueues the job
+    // and the prerequisite jobs of the chunks missing it on the calling worker, counted as wasted.
+    bool PollDependencies(Job job, JobType prerequisite_job, World_Chunk_Stage prerequisite_stage);
+
+    // Called from main thread, m_JobQueueMutex held.
+    void RequestLocalLighting_ThreadUnsafe(World_Chunk* chunk);
+    void RequestNeighbourLighting_ThreadUnsafe(World_Chunk* chunk);
+
+    TaskScheduler& m_Scheduler;
+
+    // Per worker deque, fed by follow-up jobs of the worker itself and stolen from by idle workers.
+    std::vector<std::unique_ptr<WorkStealingDeque<PackedJob>>> m_WorkerDeques;
+
+    // TaskQueue, called from scheduler workers.
+    bool RunTask(std::size_t worker_index) override;
+    bool HasTasks() const override;
+
+    std::optional<Job> TryPopJob(std::size_t worker_index);
+
+    // Enqueued jobs pin their chunk until popped.
+    // Called from main thread, m_JobQueueMutex held.
     void EnqueueDedupJob_ThreadUnsafe(Job job);
-    void GenerationJobHandler(World_Chunk* chunk);
-    void LocalLightingJobHandler(World_Chunk* chunk);
-    void NeighbourLightingJobHandler(World_Chunk* chunk);
+
+    // Called from worker thread
+    void EnqueueDedupJob_WorkerLocal(Job job);
+
+    // Return false if the job was wasted.
+    bool GenerationJobHandler(World_Chunk* chunk);
+    bool LocalLightingJobHandler(World_Chunk* chunk);
+    bool NeighbourLightingJobHandler(World_Chunk* chunk);
 };
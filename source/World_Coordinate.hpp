@@ -22,6 +22,11 @@ constexpr int World_CHUNK_Z_SIZE = 16;
 constexpr int World_CHUNK_AREA   = World_CHUNK_X_SIZE * World_CHUNK_Z_SIZE;
 constexpr int World_CHUNK_VOLUME = World_CHUNK_X_SIZE * World_CHUNK_Y_SIZE * World_CHUNK_Z_SIZE;
 
+// Chunks are stored as vertical sections of 16x16x16 blocks
+constexpr int World_CHUNK_SECTION_Y_SIZE = 16;
+constexpr int World_CHUNK_SECTION_COUNT  = World_CHUNK_Y_SIZE / World_CHUNK_SECTION_Y_SIZE;
+constexpr int World_CHUNK_SECTION_VOLUME = World_CHUNK_X_SIZE * World_CHUNK_SECTION_Y_SIZE * World_CHUNK_Z_SIZE;
+
 constexpr World_Chunk_ID World_FromGlobalToChunkID(World_GlobalXYZ position)
 {
     int& x = position.x;
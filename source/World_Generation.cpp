@@ -1,12 +1,14 @@
 #include "World_Generation.hpp"
 
+#include <cassert>
 #include <algorithm>
+#include <array>
+#include <vector>
 #include <FastNoise/FastNoise.h>
-#include "Utility_Array2D.hpp"
-#include "Utility_Array3D.hpp"
 #include "World_Coordinate.hpp"
 #include "World_Block.hpp"
 #include "World_Chunk.hpp"
+#include "World_GenerationKernel.hpp"
 
 namespace
 {
@@ -18,7 +20,9 @@ namespace
     constexpr std::size_t SAMPLE_Y_SIZE = World_CHUNK_Y_SIZE;
     constexpr std::size_t SAMPLE_Z_SIZE = World_CHUNK_Z_SIZE;
 
-    int GenerationSeed;
+    int GenerationSeed; // Set before any thread generates
+
+    World_Generation_Settings Settings;
 
     // Terrain noise
     thread_local FastNoise::SmartNode<FastNoise::FractalFBm>  ContinentalnessNoise{};
@@ -28,159 +32,364 @@ namespace
     thread_local FastNoise::SmartNode<FastNoise::FractalFBm>  SpaghettiCavernNoise1{};
     thread_local FastNoise::SmartNode<FastNoise::FractalFBm>  SpaghettiCavernNoise2{};
 
+    // Noise samples over the region being generated, laid out as FastNoise fills its grids: x fastest, then y, then z.
+    struct RegionSamples
+    {
+        int                X = 0;
+        int                Y = 0;
+        int                Z = 0;
+        std::vector<float> Data;
+
+        void Resize(int x, int y, int z)
+        {
+            X = x; Y = y; Z = z;
+            Data.resize(static_cast<std::size_t>(x * y * z));
+        }
+
+        float&       At(int x, int y, int z)       { return Data[static_cast<std::size_t>(x + X * (y + Y * z))]; }
+        const float& At(int x, int y, int z) const { return Data[static_cast<std::size_t>(x + X * (y + Y * z))]; }
+    };
+
     // Noise sample storage
-    thread_local Array2D<float, SAMPLE_X_SIZE, SAMPLE_Z_SIZE>                ContinentalnessSamples;
-    thread_local Array3D<float, SAMPLE_X_SIZE, SAMPLE_Y_SIZE, SAMPLE_Z_SIZE> CheeseCavernSamples;
-    thread_local Array3D<float, SAMPLE_X_SIZE, SAMPLE_Y_SIZE, SAMPLE_Z_SIZE> SpaghettiCavernSamples1;
-    thread_local Array3D<float, SAMPLE_X_SIZE, SAMPLE_Y_SIZE, SAMPLE_Z_SIZE> SpaghettiCavernSamples2;
+    thread_local RegionSamples    ContinentalnessSamples; // Y == 1
+    thread_local std::vector<int> TerrainHeights;         // Per block column of the region
+
+    // Cave noise of the section being generated. Only sections reaching down to the terrain are sampled.
+    thread_local RegionSamples CheeseCavernSamples;
+    thread_local RegionSamples SpaghettiCavernSamples1;
+    thread_local RegionSamples SpaghettiCavernSamples2;
+
+    // Lattice sampling: cave noise on the lattice below the sampled sections, per noise,
+    // and the lattice interpolated along y over the current section for every lattice column.
+    thread_local RegionSamples CheeseCavernLattice;
+    thread_local RegionSamples SpaghettiCavernLattice1;
+    thread_local RegionSamples SpaghettiCavernLattice2;
+    thread_local RegionSamples CaveColumnSamples; // Lattice columns over the current section
+
+    // Cave noise over a uniform grid, the three fields.
+    void GenerateCaveGrids(glm::vec3 start, glm::ivec3 size, glm::vec3 step, float* cheese, float* spaghetti1, float* spaghetti2)
+    {
+        const int cheese_seed     = GenerationSeed;
+        const int spaghetti1_seed = GenerationSeed + 10000;
+        const int spaghetti2_seed = GenerationSeed + 20000;
+
+        CheeseCavernNoise->GenUniformGrid3D(cheese, start.x, start.y, start.z, size.x, size.y, size.z, step.x, step.y, step.z, cheese_seed);
+        SpaghettiCavernNoise1->GenUniformGrid3D(spaghetti1, start.x, start.y, start.z, size.x, size.y, size.z, step.x, step.y, step.z, spaghetti1_seed);
+        SpaghettiCavernNoise2->GenUniformGrid3D(spaghetti2, start.x, start.y, start.z, size.x, size.y, size.z, step.x, step.y, step.z, spaghetti2_seed);
+    }
+
+    // The lattice covers [0, y_end) and includes the far faces of the region, shared with the neighbouring chunks:
+    // caves stay continuous across chunk borders.
+    void GenerateCaveLattices(World_GlobalXYZ region_offset, glm::ivec2 region_size, int y_end)
+    {
+        const glm::ivec3 stride = Settings.CaveLatticeStride;
+
+        for (RegionSamples* lattice : { &CheeseCavernLattice, &SpaghettiCavernLattice1, &SpaghettiCavernLattice2 })
+        {
+            lattice->Resize(region_size.x / stride.x + 1, (y_end + stride.y - 1) / stride.y + 1, region_size.y / stride.z + 1);
+        }
 
-    void GenerateSamples(World_GlobalXYZ chunk_offset)
+        GenerateCaveGrids(
+            glm::vec3(region_offset),
+            glm::ivec3(CheeseCavernLattice.X, CheeseCavernLattice.Y, CheeseCavernLattice.Z),
+            glm::vec3(stride),
+            CheeseCavernLattice.Data.data(), SpaghettiCavernLattice1.Data.data(), SpaghettiCavernLattice2.Data.data()
+        );
+    }
+
+    // Interpolates the section starting at y_base from a lattice of GenerateCaveLattices.
+    void InterpolateCaveLattice(int y_base, const RegionSamples& lattice, RegionSamples& samples)
     {
-        float cx = static_cast<float>(chunk_offset.x);
-        float cy = static_cast<float>(chunk_offset.y);
-        float cz = static_cast<float>(chunk_offset.z);
+        const glm::ivec3 stride = Settings.CaveLatticeStride;
+
+        // Along y first, the longest axis, then bilinearly between the four columns around each block column.
+        CaveColumnSamples.Resize(lattice.X, World_CHUNK_SECTION_Y_SIZE, lattice.Z);
+
+        for (int z = 0; z < lattice.Z; z++)
+        for (int x = 0; x < lattice.X; x++)
+        {
+            for (int sy = 0; sy < World_CHUNK_SECTION_Y_SIZE; sy++)
+            {
+                const int   y0 = (y_base + sy) / stride.y;
+                const float t  = static_cast<float>((y_base + sy) % stride.y) / static_cast<float>(stride.y);
+
+                const float a = lattice.At(x, y0,     z);
+                const float b = lattice.At(x, y0 + 1, z);
+
+                CaveColumnSamples.At(x, sy, z) = a + (b - a) * t;
+            }
+        }
+
+        for (int iz = 0; iz < samples.Z; iz++)
+        for (int ix = 0; ix < samples.X; ix++)
+        {
+            const int   x0 = ix / stride.x;
+            const int   z0 = iz / stride.z;
+            const float tx = static_cast<float>(ix % stride.x) / static_cast<float>(stride.x);
+            const float tz = static_cast<float>(iz % stride.z) / static_cast<float>(stride.z);
+
+            for (int sy = 0; sy < World_CHUNK_SECTION_Y_SIZE; sy++)
+            {
+                const float c00 = CaveColumnSamples.At(x0,     sy, z0);
+                const float c10 = CaveColumnSamples.At(x0 + 1, sy, z0);
+                const float c01 = CaveColumnSamples.At(x0,     sy, z0 + 1);
+                const float c11 = CaveColumnSamples.At(x0 + 1, sy, z0 + 1);
+
+                const float lower = c00 + (c10 - c00) * tx;
+                const float upper = c01 + (c11 - c01) * tx;
+
+                samples.At(ix, sy, iz) = lower + (upper - lower) * tz;
+            }
+        }
+    }
+
+    // Cave noise of the region's section starting at y_base.
+    void GenerateCaveSectionSamples(World_GlobalXYZ region_offset, glm::ivec2 region_size, int y_base)
+    {
+        for (RegionSamples* samples : { &CheeseCavernSamples, &SpaghettiCavernSamples1, &SpaghettiCavernSamples2 })
+        {
+            samples->Resize(region_size.x, World_CHUNK_SECTION_Y_SIZE, region_size.y);
+        }
+
+        if (Settings.CaveSampling == World_Generation_CaveSampling::Full)
+        {
+            GenerateCaveGrids(
+                glm::vec3(region_offset.x, region_offset.y + y_base, region_offset.z),
+                glm::ivec3(region_size.x, World_CHUNK_SECTION_Y_SIZE, region_size.y),
+                glm::vec3(1.0f),
+                CheeseCavernSamples.Data.data(), SpaghettiCavernSamples1.Data.data(), SpaghettiCavernSamples2.Data.data()
+            );
+
+            return;
+        }
+
+        InterpolateCaveLattice(y_base, CheeseCavernLattice,     CheeseCavernSamples);
+        InterpolateCaveLattice(y_base, SpaghettiCavernLattice1, SpaghettiCavernSamples1);
+        InterpolateCaveLattice(y_base, SpaghettiCavernLattice2, SpaghettiCavernSamples2);
+    }
+
+    void GenerateTerrainSamples(World_GlobalXYZ region_offset, glm::ivec2 region_size)
+    {
+        ContinentalnessSamples.Resize(region_size.x, 1, region_size.y);
 
         ContinentalnessNoise->GenUniformGrid2D(
-            ContinentalnessSamples.Data(),
-            cx, cz,
-            SAMPLE_X_SIZE, SAMPLE_Z_SIZE,
+            ContinentalnessSamples.Data.data(),
+            static_cast<float>(region_offset.x), static_cast<float>(region_offset.z),
+            region_size.x, region_size.y,
             1.0f, 1.0f,
             GenerationSeed
         );
+    }
 
-        CheeseCavernNoise->GenUniformGrid3D(
-            CheeseCavernSamples.Data(),
-            cx, cy, cz,
-            SAMPLE_X_SIZE, SAMPLE_Y_SIZE, SAMPLE_Z_SIZE,
-            1.0f, 1.0f, 1.0f,
-            GenerationSeed
-        );
+    // Blocks of one section of a chunk at (rx, rz) in the region, from the region's cave samples.
+    void FillSectionBlocks(World_Chunk* chunk, int rx, int rz, int y_base, World_Chunk_FlatSectionBlockData& blocks)
+    {
+        // Position of the chunk in the region's samples
+        const int sx = rx * World_CHUNK_X_SIZE;
+        const int sz = rz * World_CHUNK_Z_SIZE;
 
-        SpaghettiCavernNoise1->GenUniformGrid3D(
-            SpaghettiCavernSamples1.Data(),
-            cx, cy, cz,
-            SAMPLE_X_SIZE, SAMPLE_Y_SIZE, SAMPLE_Z_SIZE,
-            1.0f, 1.0f, 1.0f,
-            GenerationSeed + 10000
-        );
+        const int sample_offset = sx + CheeseCavernSamples.X * World_CHUNK_SECTION_Y_SIZE * sz;
 
-        SpaghettiCavernNoise2->GenUniformGrid3D(
-            SpaghettiCavernSamples2.Data(),
-            cx, cy, cz,
-            SAMPLE_X_SIZE, SAMPLE_Y_SIZE, SAMPLE_Z_SIZE,
-            1.0f, 1.0f, 1.0f,
-            GenerationSeed + 20000
-        );
+        const World_GenerationKernel_SectionSamples samples{
+            CheeseCavernSamples.Data.data()     + sample_offset,
+            SpaghettiCavernSamples1.Data.data() + sample_offset,
+            SpaghettiCavernSamples2.Data.data() + sample_offset,
+            CheeseCavernSamples.X,
+            CheeseCavernSamples.X * World_CHUNK_SECTION_Y_SIZE
+        };
+
+        thread_local std::array<World_Block_ID, World_CHUNK_X_SIZE * World_CHUNK_SECTION_Y_SIZE * World_CHUNK_Z_SIZE> ids;
+        thread_local std::array<int, World_CHUNK_X_SIZE * World_CHUNK_Z_SIZE>                                        tops;
+
+        World_GenerationKernel_ClassifySection(samples, &TerrainHeights[static_cast<std::size_t>(sx + sz * ContinentalnessSamples.X)], ContinentalnessSamples.X,
+                                               y_base, ids.data(), tops.data());
+
+        for (int iz = 0; iz < World_CHUNK_Z_SIZE; iz++)
+        for (int sy = 0; sy < World_CHUNK_SECTION_Y_SIZE; sy++)
+        for (int ix = 0; ix < World_CHUNK_X_SIZE; ix++)
+        {
+            blocks.At(ix, sy, iz).ID = ids[static_cast<std::size_t>(ix + World_CHUNK_X_SIZE * (sy + World_CHUNK_SECTION_Y_SIZE * iz))];
+        }
+
+        // Populate height data, sections are filled bottom up.
+        for (int iz = 0; iz < World_CHUNK_Z_SIZE; iz++)
+        for (int ix = 0; ix < World_CHUNK_X_SIZE; ix++)
+        {
+            const int top = tops[static_cast<std::size_t>(ix + iz * World_CHUNK_X_SIZE)];
+
+            if (top >= 0) chunk->Storage->Heights.At(ix, iz) = static_cast<std::uint8_t>(top);
+        }
+    }
+
+    // Noise generators are per thread, built on the first generation of each thread.
+    thread_local bool ThreadNoiseBuilt = false;
+
+    void BuildThreadNoise()
+    {
+        if (ThreadNoiseBuilt) return;
+
+        ThreadNoiseBuilt = true;
+
+        {
+            auto continentalness_source = FastNoise::New<FastNoise::SuperSimplex>();
+            continentalness_source->SetScale(CONTINENTALNESS_SCALE);
+
+            ContinentalnessNoise = FastNoise::New<FastNoise::FractalFBm>();
+            ContinentalnessNoise->SetSource(continentalness_source);
+            ContinentalnessNoise->SetOctaveCount(5);
+            ContinentalnessNoise->SetLacunarity(2.6f);
+            ContinentalnessNoise->SetGain(0.5f);
+        }
+
+        {
+            auto cheese_cavern_source = FastNoise::New<FastNoise::Simplex>();
+            cheese_cavern_source->SetScale(CHEESE_CAVERN_SCALE);
+
+            auto domain_axis_scale = FastNoise::New<FastNoise::DomainAxisScale>();
+            domain_axis_scale->SetSource(cheese_cavern_source);
+            domain_axis_scale->SetScaling<FastNoise::Dim::X>(0.8f);
+            domain_axis_scale->SetScaling<FastNoise::Dim::Z>(0.8f);
+            domain_axis_scale->SetScaling<FastNoise::Dim::Y>(1.4f);
+
+            CheeseCavernNoise = FastNoise::New<FastNoise::FractalFBm>();
+            CheeseCavernNoise->SetSource(cheese_cavern_source);
+            CheeseCavernNoise->SetOctaveCount(5);
+            CheeseCavernNoise->SetLacunarity(2.2f);
+            CheeseCavernNoise->SetGain(0.5f);
+        }
+
+        {
+            auto spaghetti_cavern_source = FastNoise::New<FastNoise::Simplex>();
+            spaghetti_cavern_source->SetScale(SPAGHETTI_CAVERN_SCALE);
+
+            auto domain_axis_scale = FastNoise::New<FastNoise::DomainAxisScale>();
+            domain_axis_scale->SetSource(spaghetti_cavern_source);
+            domain_axis_scale->SetScaling<FastNoise::Dim::X>(0.8f);
+            domain_axis_scale->SetScaling<FastNoise::Dim::Z>(0.8f);
+            domain_axis_scale->SetScaling<FastNoise::Dim::Y>(1.2f);
+
+            SpaghettiCavernNoise1 = FastNoise::New<FastNoise::FractalFBm>();
+            SpaghettiCavernNoise1->SetSource(domain_axis_scale);
+            CheeseCavernNoise->SetOctaveCount(4);
+            SpaghettiCavernNoise1->SetLacunarity(2.4f);
+
+            SpaghettiCavernNoise2 = FastNoise::New<FastNoise::FractalFBm>();
+            SpaghettiCavernNoise2->SetSource(domain_axis_scale);
+            CheeseCavernNoise->SetOctaveCount(4);
+            SpaghettiCavernNoise2->SetLacunarity(2.4f);
+        }
     }
 }
 
 void World_Generation_Initialize(int generation_seed)
 {
     GenerationSeed = generation_seed;
+}
 
-    {
-        auto continentalness_source = FastNoise::New<FastNoise::SuperSimplex>();
-        continentalness_source->SetScale(CONTINENTALNESS_SCALE);
-
-        ContinentalnessNoise = FastNoise::New<FastNoise::FractalFBm>();
-        ContinentalnessNoise->SetSource(continentalness_source);
-        ContinentalnessNoise->SetOctaveCount(5);
-        ContinentalnessNoise->SetLacunarity(2.6f);
-        ContinentalnessNoise->SetGain(0.5f);
-    }
+void World_Generation_SetSettings(const World_Generation_Settings& settings)
+{
+    assert(settings.CaveLatticeStride.x > 0 && SAMPLE_X_SIZE % static_cast<std::size_t>(settings.CaveLatticeStride.x) == 0);
+    assert(settings.CaveLatticeStride.y > 0 && SAMPLE_Y_SIZE % static_cast<std::size_t>(settings.CaveLatticeStride.y) == 0);
+    assert(settings.CaveLatticeStride.z > 0 && SAMPLE_Z_SIZE % static_cast<std::size_t>(settings.CaveLatticeStride.z) == 0);
 
-    {
-        auto cheese_cavern_source = FastNoise::New<FastNoise::Simplex>();
-        cheese_cavern_source->SetScale(CHEESE_CAVERN_SCALE);
-
-        auto domain_axis_scale = FastNoise::New<FastNoise::DomainAxisScale>();
-        domain_axis_scale->SetSource(cheese_cavern_source);
-        domain_axis_scale->SetScaling<FastNoise::Dim::X>(0.8f);
-        domain_axis_scale->SetScaling<FastNoise::Dim::Z>(0.8f);
-        domain_axis_scale->SetScaling<FastNoise::Dim::Y>(1.4f);
-
-        CheeseCavernNoise = FastNoise::New<FastNoise::FractalFBm>();
-        CheeseCavernNoise->SetSource(cheese_cavern_source);
-        CheeseCavernNoise->SetOctaveCount(5);
-        CheeseCavernNoise->SetLacunarity(2.2f);
-        CheeseCavernNoise->SetGain(0.5f);
-    }
+    Settings = settings;
+}
 
-    {
-        auto spaghetti_cavern_source = FastNoise::New<FastNoise::Simplex>();
-        spaghetti_cavern_source->SetScale(SPAGHETTI_CAVERN_SCALE);
-
-        auto domain_axis_scale = FastNoise::New<FastNoise::DomainAxisScale>();
-        domain_axis_scale->SetSource(spaghetti_cavern_source);
-        domain_axis_scale->SetScaling<FastNoise::Dim::X>(0.8f);
-        domain_axis_scale->SetScaling<FastNoise::Dim::Z>(0.8f);
-        domain_axis_scale->SetScaling<FastNoise::Dim::Y>(1.2f);
-
-        SpaghettiCavernNoise1 = FastNoise::New<FastNoise::FractalFBm>();
-        SpaghettiCavernNoise1->SetSource(domain_axis_scale);
-        CheeseCavernNoise->SetOctaveCount(4);
-        SpaghettiCavernNoise1->SetLacunarity(2.4f);
-
-        SpaghettiCavernNoise2 = FastNoise::New<FastNoise::FractalFBm>();
-        SpaghettiCavernNoise2->SetSource(domain_axis_scale);
-        CheeseCavernNoise->SetOctaveCount(4);
-        SpaghettiCavernNoise2->SetLacunarity(2.4f);
-    }
+const World_Generation_Settings& World_Generation_GetSettings()
+{
+    return Settings;
 }
 
+
 void World_Generation_GenerateChunk(World_Chunk* chunk)
 {
-    auto chunk_offset = World_FromChunkIDToChunkOffset(chunk->ID);
+    World_Generation_GenerateRegion(chunk->ID, glm::ivec2(1, 1), &chunk);
+}
 
-    // Populate noise maps
-    GenerateSamples(chunk_offset);
+void World_Generation_GenerateRegion(World_Chunk_ID origin, glm::ivec2 size, World_Chunk* const* chunks)
+{
+    BuildThreadNoise();
+
+    const World_GlobalXYZ region_offset = World_FromChunkIDToChunkOffset(origin);
+    const glm::ivec2      region_size{ size.x * World_CHUNK_X_SIZE, size.y * World_CHUNK_Z_SIZE };
+
+    // Terrain first, cave noise is only needed below its surface.
+    GenerateTerrainSamples(region_offset, region_size);
+
+    TerrainHeights.resize(ContinentalnessSamples.Data.size());
 
-    // Populate block data
-    for (int iz = 0; iz < World_CHUNK_Z_SIZE; iz++)
+    for (std::size_t i = 0; i < TerrainHeights.size(); i++)
     {
-        for (int ix = 0; ix < World_CHUNK_X_SIZE; ix++)
-        {
-            const int height = static_cast<int>(std::floor(ContinentalnessSamples.At(ix, iz) * 64 + World_SEA_LEVEL + 64));
+        TerrainHeights[i] = static_cast<int>(std::floor(ContinentalnessSamples.Data[i] * 64 + World_SEA_LEVEL + 64));
+    }
 
-            chunk->Storage->Blocks.At(ix, 0, iz).ID = World_Block_ID::BEDROCK;
+    // Highest terrain column per chunk, and over the chunks to generate.
+    thread_local std::vector<int> max_heights;
+    max_heights.assign(static_cast<std::size_t>(size.x * size.y), -1);
 
-            for (int iy = 1; iy < World_CHUNK_Y_SIZE; iy++)
-            {
-                auto& block = chunk->Storage->Blocks.At(ix, iy, iz);
+    int region_max_height = -1;
 
-                float cheese_sample     = CheeseCavernSamples.At(ix, iy, iz);
-                float spaghetti_sample1 = SpaghettiCavernSamples1.At(ix, iy, iz);
-                float spaghetti_sample2 = SpaghettiCavernSamples2.At(ix, iy, iz);
+    for (int rz = 0; rz < size.y; rz++)
+    for (int rx = 0; rx < size.x; rx++)
+    {
+        World_Chunk* chunk = chunks[rx + rz * size.x];
 
-                constexpr float thickness = 0.085f;
+        if (chunk == nullptr) continue;
 
-                float density = static_cast<float>(iy) / static_cast<float>(height);
+        int& max_height = max_heights[static_cast<std::size_t>(rx + rz * size.x)];
 
-                bool hollow = (
-                    (spaghetti_sample1 < thickness && spaghetti_sample1 > -thickness) &&
-                    (spaghetti_sample2 < thickness && spaghetti_sample2 > -thickness)) || cheese_sample < (-0.65f - density);
+        for (int iz = 0; iz < World_CHUNK_Z_SIZE; iz++)
+        for (int ix = 0; ix < World_CHUNK_X_SIZE; ix++)
+        {
+            const int sx = rx * World_CHUNK_X_SIZE + ix;
+            const int sz = rz * World_CHUNK_Z_SIZE + iz;
 
-                if (iy < height && !hollow)         block.ID = World_Block_ID::STONE;
-                else if (iy == height && !hollow)   block.ID = World_Block_ID::GRASS;
-                else                                block.ID = World_Block_ID::AIR;
-            }
+            max_height = std::max(max_height, TerrainHeights[static_cast<std::size_t>(sx + sz * region_size.x)]);
+
+            chunk->Storage->Heights.At(ix, iz) = 0;
         }
+
+        region_max_height = std::max(region_max_height, max_height);
     }
 
-    // Populate height data
-    for (int iz = 0; iz < World_CHUNK_Z_SIZE; iz++)
+    // End of the sections reaching down to the terrain
+    const int sampled_y_end = std::min((region_max_height / World_CHUNK_SECTION_Y_SIZE + 1) * World_CHUNK_SECTION_Y_SIZE, World_CHUNK_Y_SIZE);
+
+    if (Settings.CaveSampling == World_Generation_CaveSampling::Lattice)
     {
-        for (int ix = 0; ix < World_CHUNK_X_SIZE; ix++)
+        GenerateCaveLattices(region_offset, region_size, sampled_y_end);
+    }
+
+    // Populate block data section by section. Sections above the terrain are uniform air and skipped,
+    // starting sunlit as they are fully exposed to the sky.
+    thread_local World_Chunk_FlatSectionBlockData blocks;
+
+    for (int s = 0; s < World_CHUNK_SECTION_COUNT; s++)
+    {
+        const int y_base = s * World_CHUNK_SECTION_Y_SIZE;
+
+        if (y_base <= region_max_height)
         {
-            for (int iy = World_CHUNK_Y_SIZE - 1; iy >= 0; iy--)
-            {
-                if (chunk->Storage->Blocks.At(ix, iy, iz).ID != World_Block_ID::AIR)
-                {
-                    chunk->Storage->Heights.At(ix, iz) = static_cast<std::uint8_t>(iy);
+            GenerateCaveSectionSamples(region_offset, region_size, y_base);
+        }
+
+        for (int rz = 0; rz < size.y; rz++)
+        for (int rx = 0; rx < size.x; rx++)
+        {
+            World_Chunk* chunk = chunks[rx + rz * size.x];
+
+            if (chunk == nullptr) continue;
 
-                    break;
-                }
+            if (y_base > max_heights[static_cast<std::size_t>(rx + rz * size.x)])
+            {
+                blocks.Fill(World_Block(World_Block_ID::AIR));
+                chunk->EncodeSectionBlocks(s, blocks, World_LIGHT_LEVEL_SUN);
+                continue;
             }
+
+            FillSectionBlocks(chunk, rx, rz, y_base, blocks);
+
+            chunk->EncodeSectionBlocks(s, blocks, World_LIGHT_LEVEL_MIN);
         }
     }
 }
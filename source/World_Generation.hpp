@@ -1,7 +1,34 @@
 #pragma once
 
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include "World_Coordinate.hpp"
+
 struct World_Chunk;
 
+enum class World_Generation_CaveSampling
+{
+    Full,    // Cave noise evaluated at every block
+    Lattice, // Cave noise evaluated every CaveLatticeStride blocks, trilinearly interpolated in between
+};
+
+struct World_Generation_Settings
+{
+    World_Generation_CaveSampling CaveSampling = World_Generation_CaveSampling::Full;
+
+    // Divides the chunk size along each axis. Far below the cave scales (220 blocks), so caves keep their shape.
+    glm::ivec3 CaveLatticeStride{ 4, 8, 4 };
+};
+
+// Sets the world seed, before any thread generates. Noise generators are built per thread on first use.
 void World_Generation_Initialize(int generation_seed);
 
+// Shared by every thread, set before generating chunks.
+void World_Generation_SetSettings(const World_Generation_Settings& settings);
+const World_Generation_Settings& World_Generation_GetSettings();
+
 void World_Generation_GenerateChunk(World_Chunk* chunk);
+
+// Generates a size.x by size.y (x, z) block of chunks starting at origin with one noise grid per node, cheaper per chunk
+// than generating them one by one. chunks[x + z * size.x] is the chunk at origin + (x, 0, z), null ones are skipped.
+void World_Generation_GenerateRegion(World_Chunk_ID origin, glm::ivec2 size, World_Chunk* const* chunks);
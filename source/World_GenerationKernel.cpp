@@ -0,0 +1,258 @@
+#include "World_GenerationKernel.hpp"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define NITROCRAFT_GENERATION_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define NITROCRAFT_GENERATION_KERNEL_SSE2
+#endif
+
+namespace
+{
+    // Spaghetti caves are where both spaghetti noises are within SPAGHETTI_THICKNESS of zero.
+    // Cheese caves are where the cheese noise is below CHEESE_THRESHOLD minus the block's relative height in its column.
+    constexpr float SPAGHETTI_THICKNESS = 0.085f;
+    constexpr float CHEESE_THRESHOLD    = -0.65f;
+
+    constexpr int X_SIZE = World_CHUNK_X_SIZE;
+    constexpr int Y_SIZE = World_CHUNK_SECTION_Y_SIZE;
+    constexpr int Z_SIZE = World_CHUNK_Z_SIZE;
+
+#if defined(NITROCRAFT_GENERATION_KERNEL_AVX2)
+    // 16 block rows along x as two 8 lane halves. Per row, the column tops stay in registers across the section's height.
+    void ClassifySectionAVX2(const World_GenerationKernel_SectionSamples& samples, const int* heights, int heights_stride, int y_base,
+                             World_Block_ID* ids, int* tops)
+    {
+        constexpr int LANES = 8;
+        constexpr int GROUPS = X_SIZE / LANES;
+
+        const __m256  thickness     = _mm256_set1_ps(SPAGHETTI_THICKNESS);
+        const __m256  neg_thickness = _mm256_set1_ps(-SPAGHETTI_THICKNESS);
+        const __m256  cheese        = _mm256_set1_ps(CHEESE_THRESHOLD);
+        const __m256i stone_id      = _mm256_set1_epi32(static_cast<int>(World_Block_ID::STONE));
+        const __m256i grass_id      = _mm256_set1_epi32(static_cast<int>(World_Block_ID::GRASS));
+
+        for (int iz = 0; iz < Z_SIZE; iz++)
+        {
+            __m256i height[GROUPS], top[GROUPS];
+            __m256  height_f[GROUPS];
+
+            for (int g = 0; g < GROUPS; g++)
+            {
+                height[g]   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(heights + iz * heights_stride + g * LANES));
+                height_f[g] = _mm256_cvtepi32_ps(height[g]);
+                top[g]      = _mm256_set1_epi32(-1);
+            }
+
+            for (int sy = 0; sy < Y_SIZE; sy++)
+            {
+                const int iy = y_base + sy;
+
+                World_Block_ID* id_row = ids + X_SIZE * (sy + Y_SIZE * iz);
+
+                if (iy == 0)
+                {
+                    std::memset(id_row, static_cast<int>(World_Block_ID::BEDROCK), X_SIZE);
+                    for (int g = 0; g < GROUPS; g++) top[g] = _mm256_setzero_si256();
+                    continue;
+                }
+
+                const __m256i y   = _mm256_set1_epi32(iy);
+                const __m256  y_f = _mm256_set1_ps(static_cast<float>(iy));
+
+                const int offset = sy * samples.RowStride + iz * samples.SliceStride;
+
+                __m128i row_ids[GROUPS];
+
+                for (int g = 0; g < GROUPS; g++)
+                {
+                    const __m256 cheese_sample     = _mm256_loadu_ps(samples.Cheese     + offset + g * LANES);
+                    const __m256 spaghetti_sample1 = _mm256_loadu_ps(samples.Spaghetti1 + offset + g * LANES);
+                    const __m256 spaghetti_sample2 = _mm256_loadu_ps(samples.Spaghetti2 + offset + g * LANES);
+
+                    const __m256 spaghetti = _mm256_and_ps(
+                        _mm256_and_ps(_mm256_cmp_ps(spaghetti_sample1, thickness, _CMP_LT_OQ), _mm256_cmp_ps(spaghetti_sample1, neg_thickness, _CMP_GT_OQ)),
+                        _mm256_and_ps(_mm256_cmp_ps(spaghetti_sample2, thickness, _CMP_LT_OQ), _mm256_cmp_ps(spaghetti_sample2, neg_thickness, _CMP_GT_OQ)));
+
+                    // Lanes above the terrain may divide by a non-positive height, they are masked out below.
+                    const __m256 density = _mm256_div_ps(y_f, height_f[g]);
+                    const __m256 cave    = _mm256_cmp_ps(cheese_sample, _mm256_sub_ps(cheese, density), _CMP_LT_OQ);
+
+                    const __m256i hollow = _mm256_castps_si256(_mm256_or_ps(spaghetti, cave));
+
+                    const __m256i stone = _mm256_andnot_si256(hollow, _mm256_cmpgt_epi32(height[g], y));
+                    const __m256i grass = _mm256_andnot_si256(hollow, _mm256_cmpeq_epi32(height[g], y));
+
+                    const __m256i id = _mm256_or_si256(_mm256_and_si256(stone, stone_id), _mm256_and_si256(grass, grass_id));
+
+                    top[g] = _mm256_blendv_epi8(top[g], y, _mm256_or_si256(stone, grass));
+
+                    row_ids[g] = _mm_packs_epi32(_mm256_castsi256_si128(id), _mm256_extracti128_si256(id, 1));
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(id_row), _mm_packus_epi16(row_ids[0], row_ids[1]));
+            }
+
+            for (int g = 0; g < GROUPS; g++) _mm256_storeu_si256(reinterpret_cast<__m256i*>(tops + iz * X_SIZE + g * LANES), top[g]);
+        }
+    }
+#elif defined(NITROCRAFT_GENERATION_KERNEL_SSE2)
+    // 16 block rows along x as four 4 lane quarters. Per row, the column tops stay in registers across the section's height.
+    // SSE2 has no blend, selects are and/andnot/or.
+    void ClassifySectionSSE2(const World_GenerationKernel_SectionSamples& samples, const int* heights, int heights_stride, int y_base,
+                             World_Block_ID* ids, int* tops)
+    {
+        constexpr int LANES = 4;
+        constexpr int GROUPS = X_SIZE / LANES;
+
+        const __m128  thickness     = _mm_set1_ps(SPAGHETTI_THICKNESS);
+        const __m128  neg_thickness = _mm_set1_ps(-SPAGHETTI_THICKNESS);
+        const __m128  cheese        = _mm_set1_ps(CHEESE_THRESHOLD);
+        const __m128i stone_id      = _mm_set1_epi32(static_cast<int>(World_Block_ID::STONE));
+        const __m128i grass_id      = _mm_set1_epi32(static_cast<int>(World_Block_ID::GRASS));
+
+        for (int iz = 0; iz < Z_SIZE; iz++)
+        {
+            __m128i height[GROUPS], top[GROUPS];
+            __m128  height_f[GROUPS];
+
+            for (int g = 0; g < GROUPS; g++)
+            {
+                height[g]   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(heights + iz * heights_stride + g * LANES));
+                height_f[g] = _mm_cvtepi32_ps(height[g]);
+                top[g]      = _mm_set1_epi32(-1);
+            }
+
+            for (int sy = 0; sy < Y_SIZE; sy++)
+            {
+                const int iy = y_base + sy;
+
+                World_Block_ID* id_row = ids + X_SIZE * (sy + Y_SIZE * iz);
+
+                if (iy == 0)
+                {
+                    std::memset(id_row, static_cast<int>(World_Block_ID::BEDROCK), X_SIZE);
+                    for (int g = 0; g < GROUPS; g++) top[g] = _mm_setzero_si128();
+                    continue;
+                }
+
+                const __m128i y   = _mm_set1_epi32(iy);
+                const __m128  y_f = _mm_set1_ps(static_cast<float>(iy));
+
+                const int offset = sy * samples.RowStride + iz * samples.SliceStride;
+
+                __m128i row_ids[GROUPS];
+
+                for (int g = 0; g < GROUPS; g++)
+                {
+                    const __m128 cheese_sample     = _mm_loadu_ps(samples.Cheese     + offset + g * LANES);
+                    const __m128 spaghetti_sample1 = _mm_loadu_ps(samples.Spaghetti1 + offset + g * LANES);
+                    const __m128 spaghetti_sample2 = _mm_loadu_ps(samples.Spaghetti2 + offset + g * LANES);
+
+                    const __m128 spaghetti = _mm_and_ps(
+                        _mm_and_ps(_mm_cmplt_ps(spaghetti_sample1, thickness), _mm_cmpgt_ps(spaghetti_sample1, neg_thickness)),
+                        _mm_and_ps(_mm_cmplt_ps(spaghetti_sample2, thickness), _mm_cmpgt_ps(spaghetti_sample2, neg_thickness)));
+
+                    // Lanes above the terrain may divide by a non-positive height, they are masked out below.
+                    const __m128 density = _mm_div_ps(y_f, height_f[g]);
+                    const __m128 cave    = _mm_cmplt_ps(cheese_sample, _mm_sub_ps(cheese, density));
+
+                    const __m128i hollow = _mm_castps_si128(_mm_or_ps(spaghetti, cave));
+
+                    const __m128i stone = _mm_andnot_si128(hollow, _mm_cmpgt_epi32(height[g], y));
+                    const __m128i grass = _mm_andnot_si128(hollow, _mm_cmpeq_epi32(height[g], y));
+                    const __m128i solid = _mm_or_si128(stone, grass);
+
+                    row_ids[g] = _mm_or_si128(_mm_and_si128(stone, stone_id), _mm_and_si128(grass, grass_id));
+
+                    top[g] = _mm_or_si128(_mm_and_si128(solid, y), _mm_andnot_si128(solid, top[g]));
+                }
+
+                const __m128i ids_lo = _mm_packs_epi32(row_ids[0], row_ids[1]);
+                const __m128i ids_hi = _mm_packs_epi32(row_ids[2], row_ids[3]);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(id_row), _mm_packus_epi16(ids_lo, ids_hi));
+            }
+
+            for (int g = 0; g < GROUPS; g++) _mm_storeu_si128(reinterpret_cast<__m128i*>(tops + iz * X_SIZE + g * LANES), top[g]);
+        }
+    }
+#endif
+}
+
+void World_GenerationKernel_ClassifySection(const World_GenerationKernel_SectionSamples& samples, const int* heights, int heights_stride, int y_base,
+                                            World_Block_ID* ids, int* tops)
+{
+#if defined(NITROCRAFT_GENERATION_KERNEL_AVX2)
+    ClassifySectionAVX2(samples, heights, heights_stride, y_base, ids, tops);
+#elif defined(NITROCRAFT_GENERATION_KERNEL_SSE2)
+    ClassifySectionSSE2(samples, heights, heights_stride, y_base, ids, tops);
+#else
+    World_GenerationKernel_ClassifySection_Scalar(samples, heights, heights_stride, y_base, ids, tops);
+#endif
+}
+
+void World_GenerationKernel_ClassifySection_Scalar(const World_GenerationKernel_SectionSamples& samples, const int* heights, int heights_stride, int y_base,
+                                                   World_Block_ID* ids, int* tops)
+{
+    for (int iz = 0; iz < Z_SIZE; iz++)
+    {
+        for (int ix = 0; ix < X_SIZE; ix++)
+        {
+            const int height = heights[ix + iz * heights_stride];
+
+            int& top = tops[ix + iz * X_SIZE];
+            top = -1;
+
+            for (int sy = 0; sy < Y_SIZE; sy++)
+            {
+                const int iy = y_base + sy;
+
+                World_Block_ID& id = ids[ix + X_SIZE * (sy + Y_SIZE * iz)];
+
+                if (iy == 0)
+                {
+                    id = World_Block_ID::BEDROCK;
+                }
+                else if (iy > height)
+                {
+                    id = World_Block_ID::AIR;
+                }
+                else
+                {
+                    const int offset = ix + sy * samples.RowStride + iz * samples.SliceStride;
+
+                    const float cheese_sample     = samples.Cheese[offset];
+                    const float spaghetti_sample1 = samples.Spaghetti1[offset];
+                    const float spaghetti_sample2 = samples.Spaghetti2[offset];
+
+                    const float density = static_cast<float>(iy) / static_cast<float>(height);
+
+                    const bool hollow = (
+                        (spaghetti_sample1 < SPAGHETTI_THICKNESS && spaghetti_sample1 > -SPAGHETTI_THICKNESS) &&
+                        (spaghetti_sample2 < SPAGHETTI_THICKNESS && spaghetti_sample2 > -SPAGHETTI_THICKNESS)) || cheese_sample < (CHEESE_THRESHOLD - density);
+
+                    if (iy < height && !hollow)         id = World_Block_ID::STONE;
+                    else if (iy == height && !hollow)   id = World_Block_ID::GRASS;
+                    else                                id = World_Block_ID::AIR;
+                }
+
+                if (id != World_Block_ID::AIR) top = iy;
+            }
+        }
+    }
+}
+
+const char* World_GenerationKernel_GetInstructionSet()
+{
+#if defined(NITROCRAFT_GENERATION_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(NITROCRAFT_GENERATION_KERNEL_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
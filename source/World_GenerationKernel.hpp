@@ -0,0 +1,32 @@
+#pragma once
+
+#include "World_Coordinate.hpp"
+#include "World_Block.hpp"
+
+// Block classification of terrain generation: turns the cave noise samples and the terrain heights of a chunk section
+// into block IDs, and finds the highest solid block of each column in the same pass.
+// Compiled for the best instruction set enabled at build time (NITROCRAFT_ENABLE_AVX2), SSE2 or scalar otherwise.
+
+// Cave noise of the section, sample (x, y, z) at x + y * RowStride + z * SliceStride.
+struct World_GenerationKernel_SectionSamples
+{
+    const float* Cheese     = nullptr;
+    const float* Spaghetti1 = nullptr;
+    const float* Spaghetti2 = nullptr;
+    int          RowStride   = 0;
+    int          SliceStride = 0;
+};
+
+// Classifies the blocks of the section starting at y_base.
+// heights : terrain height of column (x, z) at x + z * heights_stride.
+// ids     : written, block (x, y, z) at x + World_CHUNK_X_SIZE * (y + World_CHUNK_SECTION_Y_SIZE * z).
+// tops    : written, highest solid y of column (x, z) within the section at x + z * World_CHUNK_X_SIZE, -1 if none.
+void World_GenerationKernel_ClassifySection(const World_GenerationKernel_SectionSamples& samples, const int* heights, int heights_stride, int y_base,
+                                            World_Block_ID* ids, int* tops);
+
+// Reference implementation, one block at a time.
+void World_GenerationKernel_ClassifySection_Scalar(const World_GenerationKernel_SectionSamples& samples, const int* heights, int heights_stride, int y_base,
+                                                   World_Block_ID* ids, int* tops);
+
+// Instruction set World_GenerationKernel_ClassifySection was compiled for: "AVX2", "SSE2" or "Scalar".
+const char* World_GenerationKernel_GetInstructionSet();
@@ -1,6 +1,8 @@
 #include "World_Light.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <print> // TODO: remove
 #include "World_Coordinate.hpp"
 #include "World_Block.hpp"
@@ -91,7 +93,7 @@ void World_Light_PropagateSunlight(std::queue<World_Light_LightAdditionNode>& su
         World_Light light = chunk->GetSunlightAt(World_LocalXYZ(lx, ly, lz));
 
         // TODO: remove
-        if (chunk->NeighboursSet.load(std::memory_order_acquire) == false)
+        if (chunk->NeighboursSet().load(std::memory_order_acquire) == false)
         {
             std::println("{} {}: neighbours not set", chunk->ID.x, chunk->ID.z);
             return;
@@ -345,19 +347,38 @@ void World_Light_PropagateInitialSunlight(World_Chunk* chunk)
 
     int max_height = chunk->GetMaxHeight();
 
-    for (auto n : chunk->Neighbours)
+    for (const World_Chunk* n : chunk->Neighbours)
     {
         auto n_max = n->GetMaxHeight();
         if (n_max > max_height) max_height = n_max;
     }
 
+    // Columns walked down section by section from the opacity masks, until their first opaque block.
     for (int lz = 0; lz < World_CHUNK_Z_SIZE; lz++)
     for (int lx = 0; lx < World_CHUNK_X_SIZE; lx++)
-    for (int ly = World_CHUNK_Y_SIZE - 1; chunk->GetBlockAt(World_LocalXYZ(lx, ly, lz)).IsOpaque() == false && ly >= 0; ly--)
     {
-        chunk->SetSunlightAt(World_LocalXYZ(lx, ly, lz), World_LIGHT_LEVEL_SUN);
+        for (int s = World_CHUNK_SECTION_COUNT - 1; s >= 0; s--)
+        {
+            const int y_base = s * World_CHUNK_SECTION_Y_SIZE;
+
+            const std::uint16_t opacity = chunk->GetSectionOpacity(s, lx, lz);
+
+            // Lowest sunlit block of the section, just above its topmost opaque block.
+            const int y_sunlit = (opacity == 0) ? y_base : y_base + World_CHUNK_SECTION_Y_SIZE - std::countl_zero(opacity);
+
+            // Sections generated sunlit have nothing to write, and only need propagating from below the neighbourhood's terrain.
+            if (!(y_base > max_height && chunk->GetSectionUniformLight(s) == World_LIGHT_LEVEL_SUN))
+            {
+                for (int ly = y_base + World_CHUNK_SECTION_Y_SIZE - 1; ly >= y_sunlit; ly--)
+                {
+                    chunk->SetSunlightAt(World_LocalXYZ(lx, ly, lz), World_LIGHT_LEVEL_SUN);
+
+                    if (ly <= max_height) sunlight_add_queue.emplace(chunk, World_LocalXYZ(lx, ly, lz));
+                }
+            }
 
-        if (ly <= max_height) sunlight_add_queue.emplace(chunk, World_LocalXYZ(lx, ly, lz));
+            if (opacity != 0) break;
+        }
     }
 
     World_Light_PropagateSunlight(sunlight_add_queue);
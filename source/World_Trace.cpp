@@ -0,0 +1,134 @@
+#include "World_Trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace
+{
+constexpr std::array<char, 4> TRACE_MAGIC{ 'N', 'C', 'T', 'R' };
+constexpr std::uint16_t       TRACE_VERSION = 1;
+
+template<typename T>
+void WriteValue(std::ofstream& file, T value)
+{
+    static_assert(std::is_arithmetic_v<T>);
+
+    std::array<char, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), &value, sizeof(T));
+
+    if constexpr (std::endian::native == std::endian::big) std::reverse(bytes.begin(), bytes.end());
+
+    file.write(bytes.data(), sizeof(T));
+}
+
+template<typename T>
+bool ReadValue(std::ifstream& file, T& value)
+{
+    static_assert(std::is_arithmetic_v<T>);
+
+    std::array<char, sizeof(T)> bytes;
+
+    if (!file.read(bytes.data(), sizeof(T))) return false;
+
+    if constexpr (std::endian::native == std::endian::big) std::reverse(bytes.begin(), bytes.end());
+
+    std::memcpy(&value, bytes.data(), sizeof(T));
+
+    return true;
+}
+
+bool ReadFrame(std::ifstream& file, World_TraceFrame& frame)
+{
+    std::uint16_t edit_count = 0;
+
+    bool ok = ReadValue(file, frame.Time)
+        && ReadValue(file, frame.CameraPosition.x) && ReadValue(file, frame.CameraPosition.y) && ReadValue(file, frame.CameraPosition.z)
+        && ReadValue(file, frame.CameraYaw) && ReadValue(file, frame.CameraPitch)
+        && ReadValue(file, frame.RenderDistance)
+        && ReadValue(file, edit_count);
+
+    frame.BlockEdits.resize(ok ? edit_count : 0);
+
+    for (auto& edit : frame.BlockEdits)
+    {
+        std::uint8_t id = 0;
+
+        ok = ok && ReadValue(file, edit.Position.x) && ReadValue(file, edit.Position.y) && ReadValue(file, edit.Position.z) && ReadValue(file, id);
+
+        edit.Block = World_Block{ static_cast<World_Block_ID>(id) };
+    }
+
+    return ok;
+}
+} // namespace unnamed
+
+bool World_TraceRecorder::Open(std::string_view filepath)
+{
+    Close();
+
+    m_File.open(std::string(filepath), std::ios::binary | std::ios::trunc);
+
+    if (!m_File.is_open()) return false;
+
+    m_File.write(TRACE_MAGIC.data(), TRACE_MAGIC.size());
+    WriteValue(m_File, TRACE_VERSION);
+
+    return true;
+}
+
+void World_TraceRecorder::Close()
+{
+    if (m_File.is_open()) m_File.close();
+}
+
+void World_TraceRecorder::Record(const World_TraceFrame& frame)
+{
+    if (!m_File.is_open()) return;
+
+    const std::uint16_t edit_count = static_cast<std::uint16_t>(std::min<std::size_t>(frame.BlockEdits.size(), UINT16_MAX));
+
+    WriteValue(m_File, frame.Time);
+    WriteValue(m_File, frame.CameraPosition.x);
+    WriteValue(m_File, frame.CameraPosition.y);
+    WriteValue(m_File, frame.CameraPosition.z);
+    WriteValue(m_File, frame.CameraYaw);
+    WriteValue(m_File, frame.CameraPitch);
+    WriteValue(m_File, frame.RenderDistance);
+    WriteValue(m_File, edit_count);
+
+    for (std::size_t i = 0; i < edit_count; i++)
+    {
+        const World_TraceBlockEdit& edit = frame.BlockEdits[i];
+
+        WriteValue(m_File, edit.Position.x);
+        WriteValue(m_File, edit.Position.y);
+        WriteValue(m_File, edit.Position.z);
+        WriteValue(m_File, static_cast<std::uint8_t>(edit.Block.ID));
+    }
+}
+
+std::optional<std::vector<World_TraceFrame>> World_Trace_Load(std::string_view filepath)
+{
+    std::ifstream file(std::string(filepath), std::ios::binary);
+
+    if (!file.is_open()) return std::nullopt;
+
+    std::array<char, 4> magic{};
+    std::uint16_t       version = 0;
+
+    if (!file.read(magic.data(), magic.size()) || magic != TRACE_MAGIC) return std::nullopt;
+    if (!ReadValue(file, version) || version != TRACE_VERSION) return std::nullopt;
+
+    std::vector<World_TraceFrame> frames;
+
+    // A recording cut short ends with a partial frame, which is dropped.
+    World_TraceFrame frame;
+
+    while (ReadFrame(file, frame)) frames.push_back(frame);
+
+    return frames;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "World_Coordinate.hpp"
+#include "World_Block.hpp"
+
+// Recorded inputs driving the world, replayed to compare builds on the same workload.
+// Stored as a compact little-endian binary file: a header, then one record per frame.
+
+struct World_TraceBlockEdit
+{
+    World_GlobalXYZ Position{};
+    World_Block     Block{ World_Block_ID::AIR };
+};
+
+struct World_TraceFrame
+{
+    double                            Time = 0.0; // Seconds since the recording started
+    glm::vec3                         CameraPosition{};
+    float                             CameraYaw = 0.0f;
+    float                             CameraPitch = 0.0f;
+    std::uint8_t                      RenderDistance = 0;
+    std::vector<World_TraceBlockEdit> BlockEdits; // Applied during this frame
+};
+
+// Appends frames to a trace file as they are recorded.
+class World_TraceRecorder
+{
+public:
+    bool Open(std::string_view filepath);
+    void Close();
+
+    bool IsOpen() const { return m_File.is_open(); }
+
+    void Record(const World_TraceFrame& frame);
+
+private:
+    std::ofstream m_File;
+};
+
+// Every frame of a trace file, std::nullopt if it can't be read or is not a trace.
+std::optional<std::vector<World_TraceFrame>> World_Trace_Load(std::string_view filepath);